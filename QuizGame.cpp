@@ -8,6 +8,44 @@
     - Skip moves immediately to next question
     - When time runs out: unanswered (0), negative marking, show "Time's up!" and correct option
     - Save/Resume stores remaining seconds for current question in save_progress.txt
+    - Optional speed-bonus scoring from millisecond answer latency (integer math only)
+    - Each question produces exactly one outcome record; scoring, saving and logging all use it
+    - Seeded, portable RNG per quiz; "QuizGame --replay quiz_logs.txt [repeat]" re-scores logged sessions
+    - Head-to-head rooms: 2-4 players on one keyboard share the question set and each question's deadline
+    - Questions are rendered once into a frame buffer; redraws and room players reuse it
+    - Room answers are collected per question and scored/aggregated as one batch
+    - One process-wide question catalog: each bank file is loaded once and shared by all quizzes
+    - Banks load lazily; the last-played category is prefetched while the first menu is on screen
+    - Loader skips malformed records instead of dropping the file; "QuizGame --validate" lints banks
+    - Bank text is normalized to UTF-8 at load time (Windows-1252 lines are converted) and each
+      string's display width is stored, so frames wrap and align by columns, not bytes
+    - Bank text lives in a per-bank compressed string pool; only questions drawn into a quiz are decoded
+    - Optional Explanation:/Source:/Tags: lines per record; banks keep a dense hot array for sampling
+      and keep text and notes in cold storage that is only decoded for display
+    - Filtered quizzes ("history AND europe OR science AND easy") across all categories, evaluated on
+      per-tag/difficulty/category bitmap indexes
+    - Question types: 2-6 option choice (incl. true/false), multi-select and numeric answers
+    - Survival mode: questions are drawn one at a time without replacement until 3 misses;
+      per-question outcomes grow in chunks from a shared arena instead of a fixed array
+    - Blitz mode: as many questions as fit in 60 seconds on one clock; the next question is drawn,
+      shuffled and rendered in the idle polling time while the current one is on screen
+    - Daily challenge: one deck a day from a date seed, built and rendered once, pinned in
+      daily_deck.txt and scored on its own leaderboard (daily_scores.txt)
+    - Classic decks per (category, difficulty) are drawn ahead into small rings while the menu
+      waits, so starting a quiz pops a ready deck instead of scanning and shuffling the bank
+    - Study mode: missed questions go into a per-player review queue (kept in the player store) and
+      come back on an SM-2 schedule; the queue is a min-heap on due day, popped O(log n) per question
+    - Elo ratings for players and questions, updated after every answer; question ratings are a
+      fixed-layout binary file (ratings.dat), player ratings live in the player store;
+      "QuizGame --recompute-ratings [log]" rebuilds them from the log
+    - Player store (players.kv): per-player ratings and study queues go to an append-only log and
+      sorted, bloom-filtered segment files, merged size-tiered a step at a time while the menu waits
+    - Saved games are one slot per player in the player store instead of a single shared
+      save_progress.txt; autosaves are coalesced in memory and written within 5 seconds
+    - Autosave tracks a dirty flag and formats the save only when it writes: once per interval
+      (--autosave-seconds) or at a checkpoint (lifeline menu); --autosave-metric reports bytes/s
+    - Write-behind appends: scores, the session log and the player store log are queued per file
+      and written once per quiz, room or study session; banks are read whole in one read
    Constraints honored: NO <chrono>, NO <thread>, NO <vector>, NO <algorithm>, NO raw pointers.
    Uses <conio.h> (Visual Studio / Windows).
 */
@@ -21,36 +59,191 @@
 #include <cstdlib>   // rand, srand
 #include <cstdio>    // sscanf
 #include <limits>
+#include <sstream>   // saved games are formatted and parsed in memory
 #include <conio.h>   // _kbhit, _getch (Windows/Visual Studio)
+#ifdef _WIN32
+#define NOMINMAX      // keep numeric_limits<>::max() usable
+#include <windows.h>  // SetConsoleOutputCP: question text is printed as UTF-8
+#endif
 
 using namespace std;
 
-const int MAX_OPTIONS = 4;
+const int MAX_OPTIONS = 6; // choice questions have 2-6 options
 const int MAX_QUESTIONS = 500;
 const int MAX_QUIZ_QUESTIONS = 50;
 const int DEFAULT_TIME_PER_QUESTION = 10; // seconds
 const int EXTRA_TIME_AMOUNT = 10; // seconds added by ExtraTime lifeline
+const int SPEED_BONUS_MAX_PERCENT = 50; // instant answer earns +50% of base points
+const int FRAME_WIDTH = 78; // console columns for question/option text before wrapping
+const int MAX_BANKS = 8; // distinct bank files the catalog can hold
+const int NUM_CATEGORIES = 5;
+const string CATEGORY_NAMES[NUM_CATEGORIES] = { "Science", "Sports", "History", "Computer", "IQ/Logic" };
+const string CATEGORY_FILES[NUM_CATEGORIES] = { "science.txt", "sport.txt", "history.txt", "computer.txt", "iq.txt" };
+const int MAX_ROOM_PLAYERS = 4;
+// answer keys per room seat; the n-th key of a seat picks option n
+const string ROOM_KEYS[MAX_ROOM_PLAYERS] = { "1234", "qwer", "asdf", "zxcv" };
+
+// Question types. A record's answer line decides the type: one option number is a choice
+// question (two options make a true/false question), a comma separated list is multi-select,
+// and a record without option lines is numeric, its answer line holding the value.
+const int QUESTION_CHOICE = 0;
+const int QUESTION_MULTI = 1;
+const int QUESTION_NUMERIC = 2;
 
 struct Question {
     string text;
+    int type;                     // QUESTION_*
+    int optionCount;              // 2..MAX_OPTIONS, 0 for numeric questions
     string options[MAX_OPTIONS];
-    int correctIndex;
-    int originalCorrectIndex;
+    int answerKey;                // bank order: correct option index (choice), option bitmask (multi-select) or value (numeric)
+    int correctIndex;             // choice: shown position of the correct option
+    int correctMask;              // multi-select: bit i = shown option i is correct
+    int difficulty;
+    int bankIndex;                // position of the question in its bank file
+    int optionOrder[MAX_OPTIONS]; // optionOrder[shown position] = option position in the bank file
+    int textWidth;                // display columns of text (UTF-8 aware), computed at load
+    int optionWidths[MAX_OPTIONS];
+};
+
+// How a question ended. Every question ends in exactly one of these.
+const int OUTCOME_CORRECT = 1;
+const int OUTCOME_WRONG = 2;
+const int OUTCOME_TIMEOUT = 3; // counts as wrong, negative marking
+const int OUTCOME_SKIPPED = 4; // Skip lifeline, no penalty
+
+// One record per question. It is the only input to scoring, and it is what gets saved and logged.
+struct QuestionOutcome {
+    int questionIndex; // position in the quiz
+    int bankIndex;     // question actually shown (differs from the deck after Replace)
+    int answer;        // option pressed (1-6), 0 if none; option bitmask (multi-select); typed value (numeric)
+    int bankAnswer;    // the same answer with options numbered as in the bank file
+    int kind;          // OUTCOME_*
     int difficulty;
+    int remainingMs;   // time left on the clock at the keypress
+    int points;        // total score change, bonuses included
+    int streakBonus;
+    int speedBonus;
+};
+
+// Running totals derived from outcomes
+struct ScoreState {
+    int score;
+    int correct;
+    int wrong;
+    int streak;
 };
 
 struct QuizResult {
     string playerName;
+    unsigned int seed;   // RNG seed the quiz deck was drawn with
+    string categoryFile;
+    int difficulty;
     int score;
     int correct;
     int wrong;
     time_t timestamp;
-    int questionIndices[MAX_QUIZ_QUESTIONS];
-    int answers[MAX_QUIZ_QUESTIONS];
+    int firstChunk;      // outcome records, in chunks from the outcome arena (see appendOutcome)
+    int lastChunk;
     int qCount;
     int remainingSecondsForCurrent; // saved remaining seconds for resume
+    bool speedMode; // speed-bonus scoring enabled for this quiz
+    int mode;       // MODE_*; decides which questions the deck may draw
+};
+
+// Session modes, logged so replay rebuilds the same deck
+const int MODE_SOLO = 0;
+const int MODE_ROOM = 1;  // one keypress per answer: choice questions with at most 4 options
+const int MODE_SURVIVAL = 2; // questions drawn one at a time until SURVIVAL_LIVES misses
+const int MODE_BLITZ = 3;    // as many questions as fit in BLITZ_SECONDS on one clock
+const int MODE_DAILY = 4;    // the day's shared deck (see Daily challenge)
+const string MODE_NAMES[] = { "solo", "room", "survival", "blitz", "daily" };
+const int MODE_COUNT = 5;
+const int SURVIVAL_LIVES = 3;
+const int BLITZ_SECONDS = 60;
+
+// ---------- Outcome storage ----------
+// A session's outcome records grow in fixed chunks taken from one process-wide arena, so a
+// survival run can last as long as its questions do while a 10-question quiz takes a single
+// chunk. Chunks are linked by index; index 0 is never handed out, so a zeroed QuizResult
+// (static storage) is a valid empty one.
+const int OUTCOME_CHUNK = 16;
+const int MAX_OUTCOME_CHUNKS = 4096;
+const int NO_CHUNK = 0;
+
+struct OutcomeChunk {
+    QuestionOutcome items[OUTCOME_CHUNK];
+    int next; // next chunk of the same session, NO_CHUNK at the end
+};
+
+struct OutcomeArena {
+    OutcomeChunk chunks[MAX_OUTCOME_CHUNKS];
+    int used;     // chunks handed out so far (chunk 0 excluded)
+    int freeList; // released chunks, linked through next
 };
 
+OutcomeArena& outcomeArena() {
+    static OutcomeArena a;
+    return a;
+}
+
+void initOutcomes(QuizResult& r) {
+    r.firstChunk = NO_CHUNK; r.lastChunk = NO_CHUNK; r.qCount = 0;
+}
+
+// Give a result's chunks back to the arena and empty it
+void releaseOutcomes(QuizResult& r) {
+    OutcomeArena& a = outcomeArena();
+    if (r.firstChunk != NO_CHUNK) {
+        a.chunks[r.lastChunk].next = a.freeList;
+        a.freeList = r.firstChunk;
+    }
+    initOutcomes(r);
+}
+
+// Append one record; false if the arena is out of chunks
+bool appendOutcome(QuizResult& r, const QuestionOutcome& o) {
+    OutcomeArena& a = outcomeArena();
+    if (r.qCount % OUTCOME_CHUNK == 0) {
+        int c = a.freeList;
+        if (c != NO_CHUNK) a.freeList = a.chunks[c].next;
+        else if (a.used + 1 < MAX_OUTCOME_CHUNKS) c = ++a.used;
+        else return false;
+        a.chunks[c].next = NO_CHUNK;
+        if (r.firstChunk == NO_CHUNK) r.firstChunk = c; else a.chunks[r.lastChunk].next = c;
+        r.lastChunk = c;
+    }
+    a.chunks[r.lastChunk].items[r.qCount % OUTCOME_CHUNK] = o;
+    r.qCount++;
+    return true;
+}
+
+// Record i of a result (0 <= i < qCount)
+QuestionOutcome& outcomeAt(const QuizResult& r, int i) {
+    OutcomeArena& a = outcomeArena();
+    int c = r.lastChunk; // the latest records, which live play reads, need no walk
+    if (i / OUTCOME_CHUNK != (r.qCount - 1) / OUTCOME_CHUNK) {
+        c = r.firstChunk;
+        for (int k = i / OUTCOME_CHUNK; k > 0; --k) c = a.chunks[c].next;
+    }
+    return a.chunks[c].items[i % OUTCOME_CHUNK];
+}
+
+// Keep only the first n records
+void truncateOutcomes(QuizResult& r, int n) {
+    if (n >= r.qCount) return;
+    if (n <= 0) { releaseOutcomes(r); return; }
+    OutcomeArena& a = outcomeArena();
+    int c = r.firstChunk;
+    for (int k = (n - 1) / OUTCOME_CHUNK; k > 0; --k) c = a.chunks[c].next;
+    if (a.chunks[c].next != NO_CHUNK) {
+        a.chunks[r.lastChunk].next = a.freeList;
+        a.freeList = a.chunks[c].next;
+        a.chunks[c].next = NO_CHUNK;
+    }
+    r.lastChunk = c;
+    r.qCount = n;
+}
+
 struct ScoreEntry {
     string name;
     int score;
@@ -68,6 +261,37 @@ string nowString() {
     return "";
 }
 
+// Milliseconds since program start. clock() is wall time under the MSVC runtime,
+// which gives us sub-second resolution without <chrono>.
+long long nowMillis() {
+    return (long long)clock() * 1000 / CLOCKS_PER_SEC;
+}
+
+// Small portable PRNG (xorshift32). rand() differs between C runtimes, so everything
+// that must be reproducible from a logged seed draws from this instead.
+struct QuizRng {
+    unsigned int state;
+};
+
+void rngSeed(QuizRng& r, unsigned int seed) {
+    r.state = (seed != 0) ? seed : 0x9E3779B9u; // xorshift must not start at 0
+}
+
+unsigned int rngNext(QuizRng& r) {
+    unsigned int x = r.state;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    r.state = x;
+    return x;
+}
+
+int rngBelow(QuizRng& r, int n) {
+    return (int)(rngNext(r) % (unsigned int)n);
+}
+
+unsigned int makeSessionSeed() {
+    return (unsigned int)time(nullptr) ^ ((unsigned int)rand() << 16) ^ (unsigned int)rand();
+}
+
 int getIntInRange(int minv, int maxv) {
     while (true) {
         string s;
@@ -81,314 +305,2758 @@ int getIntInRange(int minv, int maxv) {
     }
 }
 
-// Load questions from file into outQuestions array; returns count in outCount
-bool loadQuestionsFromFile(const string& filename, Question outQuestions[], int& outCount) {
-    ifstream fin(filename.c_str());
+// ---------- File I/O ----------
+// Appends to the score files, the session log and the player store log are queued in memory
+// per file and written with one open and one write per file at flush points: the end of a
+// quiz, room or study session, a saved game, the main menu and exit. A quiz rates every
+// answer into the player store, so its many small appends become a write or two. Inside the
+// question loop the only writes left are saved games (see Saved games), which flush every
+// queue, question ratings included. A file's queue is flushed before the game reads it.
+// Banks and logs are read whole, in one read, and split into lines in memory.
+
+const int APPEND_FILES = 8;                // distinct files with queued appends
+const int APPEND_FLUSH_BYTES = 64 * 1024;  // a queue holding this much is written at once
+
+struct PendingAppend {
+    string file;
+    bool binary;
+    string data;
+};
+
+struct AppendQueue {
+    PendingAppend files[APPEND_FILES];
+    int count;
+    int appends, writes;  // totals, for --autosave-metric
+    long long bytes;
+};
+
+AppendQueue& appendQueue() {
+    static AppendQueue q;
+    return q;
+}
+
+void writePendingAppend(PendingAppend& p) {
+    if (p.data.empty()) return;
+    AppendQueue& q = appendQueue();
+    ofstream fout(p.file.c_str(), p.binary ? (ios::binary | ios::app) : ios::app);
+    if (fout.is_open()) { fout.write(p.data.data(), p.data.size()); q.writes++; q.bytes += (long long)p.data.size(); }
+    p.data.clear();
+}
+
+// Write the queued appends of one file, or of every file when file is empty
+void flushAppends(const string& file = "") {
+    AppendQueue& q = appendQueue();
+    for (int i = 0; i < q.count; ++i) if (file.empty() || q.files[i].file == file) writePendingAppend(q.files[i]);
+}
+
+// Forget a file's queued appends (it is about to be truncated)
+void dropAppends(const string& file) {
+    AppendQueue& q = appendQueue();
+    for (int i = 0; i < q.count; ++i) if (q.files[i].file == file) q.files[i].data.clear();
+}
+
+void queueAppend(const string& file, const string& text, bool binary = false) {
+    AppendQueue& q = appendQueue();
+    int i = 0;
+    while (i < q.count && q.files[i].file != file) ++i;
+    if (i == q.count) {
+        if (q.count == APPEND_FILES) { flushAppends(); q.count = 0; i = 0; }
+        q.files[i].file = file; q.files[i].binary = binary; q.files[i].data.clear();
+        q.count++;
+    }
+    q.files[i].data += text;
+    q.appends++;
+    if (q.files[i].data.size() >= (size_t)APPEND_FLUSH_BYTES) writePendingAppend(q.files[i]);
+}
+
+// The whole file in one read
+bool readWholeFile(const string& file, string& out) {
+    ifstream fin(file.c_str(), ios::binary);
     if (!fin.is_open()) return false;
+    fin.seekg(0, ios::end);
+    streamoff size = fin.tellg();
+    out.clear();
+    if (size <= 0) return true;
+    out.resize((size_t)size);
+    fin.seekg(0);
+    fin.read(&out[0], out.size());
+    out.resize((size_t)fin.gcount());
+    return true;
+}
+
+// getline over a buffer; a trailing '\r' is left for trimRight
+bool nextLine(const string& text, size_t& at, string& line) {
+    if (at >= text.size()) return false;
+    size_t end = text.find('\n', at);
+    if (end == string::npos) end = text.size();
+    line.assign(text, at, end - at);
+    at = end + 1;
+    return true;
+}
+
+// ---------- UTF-8 text ----------
+
+// Strict UTF-8 check: rejects stray continuation bytes, overlong forms, surrogates and > U+10FFFF
+bool isValidUtf8(const string& s) {
+    size_t i = 0, n = s.size();
+    while (i < n) {
+        unsigned char c = (unsigned char)s[i];
+        int extra;
+        unsigned int cp;
+        if (c < 0x80) { ++i; continue; }
+        else if (c >= 0xC2 && c <= 0xDF) { extra = 1; cp = c & 0x1F; }
+        else if (c >= 0xE0 && c <= 0xEF) { extra = 2; cp = c & 0x0F; }
+        else if (c >= 0xF0 && c <= 0xF4) { extra = 3; cp = c & 0x07; }
+        else return false;
+        if (i + extra >= n) return false;
+        for (int k = 1; k <= extra; ++k) {
+            unsigned char cc = (unsigned char)s[i + k];
+            if ((cc & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if ((extra == 2 && cp < 0x800) || (extra == 3 && (cp < 0x10000 || cp > 0x10FFFF))) return false;
+        if (cp >= 0xD800 && cp <= 0xDFFF) return false;
+        i += extra + 1;
+    }
+    return true;
+}
+
+void appendUtf8(string& out, unsigned int cp) {
+    if (cp < 0x80) out += (char)cp;
+    else if (cp < 0x800) { out += (char)(0xC0 | (cp >> 6)); out += (char)(0x80 | (cp & 0x3F)); }
+    else if (cp < 0x10000) { out += (char)(0xE0 | (cp >> 12)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+    else { out += (char)(0xF0 | (cp >> 18)); out += (char)(0x80 | ((cp >> 12) & 0x3F)); out += (char)(0x80 | ((cp >> 6) & 0x3F)); out += (char)(0x80 | (cp & 0x3F)); }
+}
+
+// Windows-1252 to UTF-8. The older banks were saved from Notepad in this code page
+// (curly quotes, the degree sign, accented names). Unassigned bytes become U+FFFD.
+string cp1252ToUtf8(const string& s) {
+    static const unsigned int high[32] = {
+        0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD,
+        0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178 };
+    string out;
+    out.reserve(s.size() + 8);
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = (unsigned char)s[i];
+        if (c < 0x80) out += (char)c;
+        else if (c < 0xA0) appendUtf8(out, high[c - 0x80]);
+        else appendUtf8(out, c); // 0xA0-0xFF match Latin-1 code points
+    }
+    return out;
+}
+
+// Make a bank line valid UTF-8; returns false if it had to be converted from Windows-1252
+bool normalizeBankText(string& s) {
+    if (isValidUtf8(s)) return true;
+    s = cp1252ToUtf8(s);
+    return false;
+}
+
+// Console columns used by one code point: 0 for combining marks and controls, 2 for wide (CJK, emoji)
+int codePointWidth(unsigned int cp) {
+    if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+    if ((cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x200B && cp <= 0x200F) || (cp >= 0xFE00 && cp <= 0xFE0F)) return 0;
+    if ((cp >= 0x1100 && cp <= 0x115F) || (cp >= 0x2E80 && cp <= 0xA4CF) || (cp >= 0xAC00 && cp <= 0xD7A3) ||
+        (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0xFE30 && cp <= 0xFE4F) || (cp >= 0xFF00 && cp <= 0xFF60) ||
+        (cp >= 0xFFE0 && cp <= 0xFFE6) || (cp >= 0x1F300 && cp <= 0x1FAFF) || (cp >= 0x20000 && cp <= 0x3FFFD)) return 2;
+    return 1;
+}
+
+// Display width of a valid UTF-8 string
+int displayWidth(const string& s) {
+    int w = 0;
+    size_t i = 0, n = s.size();
+    while (i < n) {
+        unsigned char c = (unsigned char)s[i];
+        if (c < 0x80) { w += (c >= 0x20 && c != 0x7F) ? 1 : 0; ++i; continue; }
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+        unsigned int cp = c & (0x3F >> extra);
+        for (int k = 1; k <= extra && i + k < n; ++k) cp = (cp << 6) | ((unsigned char)s[i + k] & 0x3F);
+        w += codePointWidth(cp);
+        i += extra + 1;
+    }
+    return w;
+}
+
+// Pad s with spaces up to 'columns' display columns (width is s's precomputed display width)
+string padToWidth(const string& s, int width, int columns) {
+    return (width >= columns) ? s : s + string(columns - width, ' ');
+}
+
+// Bank record layout: question, 2-6 option lines (none for numeric questions), answer line,
+// difficulty (1-3), optionally "Explanation: ...", "Source: ..." and "Tags: a, b" lines, then
+// a blank line before the next record. The answer line is the correct option number, a comma
+// separated list of them (multi-select), or the value of a numeric question.
+const int MIN_RECORD_LINES = 3; // numeric question: text, answer, difficulty
+const int MAX_META_LINES = 3;
+const int MAX_RECORD_LINES = MAX_OPTIONS + 3 + MAX_META_LINES;
+
+// Per-question notes read from the optional record lines. Only the loader and the
+// validator see this; loaded banks keep notes in their cold section.
+struct QuestionMeta {
+    string explanation;
+    string source;
+    string tags; // comma separated
+};
+
+// Read one optional record line into meta; false if it is not a known "Key: value" line
+bool parseMetaLine(const string& line, QuestionMeta& meta) {
+    if (line.compare(0, 13, "Explanation: ") == 0) { meta.explanation = line.substr(13); return true; }
+    if (line.compare(0, 8, "Source: ") == 0) { meta.source = line.substr(8); return true; }
+    if (line.compare(0, 6, "Tags: ") == 0) { meta.tags = line.substr(6); return true; }
+    return false;
+}
+
+// Where the optional note lines of a record start: they are the trailing "Key: value" lines
+int recordMetaStart(const string lines[], int lineCount) {
+    QuestionMeta scratch;
+    int start = lineCount;
+    while (start > MIN_RECORD_LINES && lineCount - start < MAX_META_LINES && parseMetaLine(lines[start - 1], scratch)) --start;
+    return start;
+}
+
+// Strip trailing spaces, tabs and the '\r' left by CRLF files
+void trimRight(string& s) {
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.pop_back();
+}
+
+// Whole-string integer: digits only (after trimming), unlike stoi which accepts "2abc"
+bool parseStrictInt(const string& s, int& out) {
+    if (s.empty() || s.size() > 9) return false;
+    int v = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        v = v * 10 + (s[i] - '0');
+    }
+    out = v;
+    return true;
+}
+
+// Answer line of a record with optionCount options: sets the type and its answer key
+// (see Question::answerKey); false if the line does not fit the options.
+bool parseAnswerLine(const string& s, int optionCount, int& type, int& key) {
+    if (optionCount == 0) {
+        bool negative = !s.empty() && s[0] == '-';
+        if (!parseStrictInt(negative ? s.substr(1) : s, key)) return false;
+        if (negative) key = -key;
+        type = QUESTION_NUMERIC;
+        return true;
+    }
+    if (s.find(',') == string::npos) {
+        if (!parseStrictInt(s, key) || key < 1 || key > optionCount) return false;
+        key--;
+        type = QUESTION_CHOICE;
+        return true;
+    }
+    key = 0;
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == string::npos) comma = s.size();
+        string item = s.substr(pos, comma - pos);
+        size_t b = item.find_first_not_of(' '), e = item.find_last_not_of(' ');
+        int n = 0;
+        if (b == string::npos || !parseStrictInt(item.substr(b, e - b + 1), n) || n < 1 || n > optionCount) return false;
+        key |= 1 << (n - 1);
+        pos = comma + 1;
+    }
+    type = QUESTION_MULTI;
+    return true;
+}
+
+// Build a Question (and its notes) from a block of lineCount trimmed lines; false if a field
+// is missing or out of range. Text lines are expected to be normalized (valid UTF-8) already.
+bool parseQuestionRecord(const string lines[], int lineCount, Question& q, QuestionMeta& meta) {
+    int diff = 0;
+    if (lineCount < MIN_RECORD_LINES || lineCount > MAX_RECORD_LINES) return false;
+    if (lines[0].empty()) return false;
+    meta.explanation.clear(); meta.source.clear(); meta.tags.clear();
+    int metaStart = recordMetaStart(lines, lineCount);
+    for (int i = metaStart; i < lineCount; ++i) parseMetaLine(lines[i], meta);
+    int optionCount = metaStart - 3;
+    if (optionCount == 1 || optionCount > MAX_OPTIONS) return false;
+    if (!parseAnswerLine(lines[metaStart - 2], optionCount, q.type, q.answerKey)) return false;
+    if (!parseStrictInt(lines[metaStart - 1], diff) || diff < 1 || diff > 3) return false;
+    q.text = lines[0];
+    q.textWidth = displayWidth(q.text);
+    q.optionCount = optionCount;
+    for (int i = 0; i < optionCount; ++i) {
+        if (lines[1 + i].empty()) return false;
+        q.options[i] = lines[1 + i];
+        q.optionWidths[i] = displayWidth(q.options[i]);
+        q.optionOrder[i] = i;
+    }
+    q.correctIndex = (q.type == QUESTION_CHOICE) ? q.answerKey : 0;
+    q.correctMask = (q.type == QUESTION_MULTI) ? q.answerKey : 0;
+    q.difficulty = diff;
+    return true;
+}
+
+// Load questions from file into outQuestions array (notes into outMeta); returns count in outCount.
+// Records are read as blank-line separated blocks. A malformed block is skipped
+// ("QuizGame --validate" reports it) and loading continues with the next one.
+bool loadQuestionsFromFile(const string& filename, Question outQuestions[], QuestionMeta outMeta[], int& outCount) {
+    string text;
+    if (!readWholeFile(filename, text)) return false;
+    size_t at = 0;
     outCount = 0;
+    string block[MAX_RECORD_LINES];
+    int blockLines = 0;
+    bool overflow = false;
     string line;
-    while (true) {
+    bool more = true;
+    while (more) {
+        more = nextLine(text, at, line);
+        if (more) { trimRight(line); normalizeBankText(line); }
+        if (more && !line.empty()) {
+            if (blockLines < MAX_RECORD_LINES) block[blockLines++] = line; else overflow = true;
+            continue;
+        }
+        // end of block
         Question q;
-        if (!getline(fin, q.text)) break;
-        if (q.text.empty()) continue;
-        for (int i = 0; i < MAX_OPTIONS; ++i) {
-            if (!getline(fin, q.options[i])) { fin.close(); return false; }
-        }
-        string corr, diff;
-        if (!getline(fin, corr)) { fin.close(); return false; }
-        if (!getline(fin, diff)) { fin.close(); return false; }
-        try {
-            q.originalCorrectIndex = stoi(corr) - 1;
-            q.correctIndex = q.originalCorrectIndex;
-            q.difficulty = stoi(diff);
+        QuestionMeta meta;
+        if (blockLines > 0 && !overflow && parseQuestionRecord(block, blockLines, q, meta) && outCount < MAX_QUESTIONS) {
+            q.bankIndex = outCount;
+            outMeta[outCount] = meta;
+            outQuestions[outCount++] = q;
         }
-        catch (...) { fin.close(); return false; }
-        if (outCount < MAX_QUESTIONS) outQuestions[outCount++] = q;
-        string blank;
-        getline(fin, blank); // optional blank line
+        blockLines = 0; overflow = false;
     }
-    fin.close();
     return outCount > 0;
 }
 
-// Simple FisherYates shuffle for int arrays
-void shuffleIntArray(int arr[], int n) {
-    for (int i = n - 1; i > 0; --i) {
-        int j = rand() % (i + 1);
-        int tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp;
+// ---------- Compressed string pool ----------
+// Bank text is stored back to back in one string per bank, compressed with a small symbol
+// table trained on that bank (FSST-style): the most profitable words are replaced by one
+// control byte each. Decoding is a table lookup per byte, so a question is cheap to expand
+// when it is drawn, and the ~490 questions per bank that are not drawn stay compressed.
+
+const int POOL_SYMBOLS = 27;
+const int MAX_SYMBOL_LEN = 16;
+const int MAX_POOL_STRINGS = MAX_QUESTIONS * (MAX_OPTIONS + 1);
+const char POOL_ESCAPE = 0x01; // next byte is a literal (for control bytes in the text itself)
+// control bytes used as symbol codes: 0x02-0x1F except tab, newline and carriage return
+const char POOL_CODES[POOL_SYMBOLS] = { 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x0B, 0x0C, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F };
+
+struct StringPool {
+    string data;                        // encoded strings, back to back
+    int offsets[MAX_POOL_STRINGS + 1];  // string i is data[offsets[i], offsets[i+1])
+    int count;
+    string symbols[POOL_SYMBOLS];       // symbols[k] is written as POOL_CODES[k]; longest first
+    int symbolCount;
+    int symbolOf[32];                   // code byte -> symbol index, -1 if unused
+    long long rawBytes;                 // size the strings would take uncompressed
+};
+
+unsigned int hashString(const string& s) {
+    unsigned int h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < s.size(); ++i) { h ^= (unsigned char)s[i]; h *= 16777619u; }
+    return h;
+}
+
+// Pick the symbol table for a set of strings: words (with their following space) ranked by
+// bytes saved, i.e. (length - 1) * occurrences.
+void trainPoolSymbols(StringPool& pool, const string texts[], int textCount) {
+    const int TABLE_SIZE = 8192; // open addressing; a bank has far fewer distinct words
+    static string keys[TABLE_SIZE];
+    static int counts[TABLE_SIZE];
+    for (int i = 0; i < TABLE_SIZE; ++i) { keys[i].clear(); counts[i] = 0; }
+    int used = 0;
+    for (int t = 0; t < textCount; ++t) {
+        const string& s = texts[t];
+        size_t pos = 0;
+        while (pos < s.size()) {
+            size_t sp = s.find(' ', pos);
+            size_t end = (sp == string::npos) ? s.size() : sp + 1; // keep the space with the word
+            if (end - pos >= 3 && end - pos <= (size_t)MAX_SYMBOL_LEN) {
+                string w = s.substr(pos, end - pos);
+                unsigned int h = hashString(w) % TABLE_SIZE;
+                while (counts[h] != 0 && keys[h] != w) h = (h + 1) % TABLE_SIZE;
+                if (counts[h] == 0) { if (used >= TABLE_SIZE / 2) { pos = end; continue; } keys[h] = w; used++; }
+                counts[h]++;
+            }
+            pos = end;
+        }
+    }
+    // selection of the POOL_SYMBOLS best gains
+    pool.symbolCount = 0;
+    for (int k = 0; k < POOL_SYMBOLS; ++k) {
+        int best = -1; long long bestGain = 0;
+        for (int i = 0; i < TABLE_SIZE; ++i) {
+            if (counts[i] < 2) continue;
+            long long gain = (long long)(keys[i].size() - 1) * counts[i];
+            if (gain > bestGain) { bestGain = gain; best = i; }
+        }
+        if (best < 0) break;
+        pool.symbols[pool.symbolCount++] = keys[best];
+        counts[best] = 0;
+    }
+    // longest first, so encoding can take the first match
+    for (int i = 1; i < pool.symbolCount; ++i) {
+        string s = pool.symbols[i]; int j = i - 1;
+        while (j >= 0 && pool.symbols[j].size() < s.size()) { pool.symbols[j + 1] = pool.symbols[j]; --j; }
+        pool.symbols[j + 1] = s;
+    }
+    for (int c = 0; c < 32; ++c) pool.symbolOf[c] = -1;
+    for (int k = 0; k < pool.symbolCount; ++k) pool.symbolOf[(int)POOL_CODES[k]] = k;
+}
+
+// Append s to the pool; returns its string id
+int poolAdd(StringPool& pool, const string& s) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+        bool matched = false;
+        for (int k = 0; k < pool.symbolCount; ++k) {
+            if (s.compare(pos, pool.symbols[k].size(), pool.symbols[k]) == 0) {
+                pool.data += POOL_CODES[k]; pos += pool.symbols[k].size(); matched = true;
+                break;
+            }
+        }
+        if (matched) continue;
+        unsigned char c = (unsigned char)s[pos++];
+        if (c < 0x20 && c != '\t') pool.data += POOL_ESCAPE;
+        pool.data += (char)c;
     }
+    pool.rawBytes += (long long)s.size();
+    pool.offsets[++pool.count] = (int)pool.data.size();
+    return pool.count - 1;
 }
 
-void shuffleOptions(Question& q) {
-    int idx[MAX_OPTIONS] = { 0,1,2,3 };
-    shuffleIntArray(idx, MAX_OPTIONS);
-    string newOpts[MAX_OPTIONS];
-    int newCorrect = 0;
-    for (int i = 0; i < MAX_OPTIONS; ++i) {
-        newOpts[i] = q.options[idx[i]];
-        if (idx[i] == q.originalCorrectIndex) newCorrect = i;
+string poolGet(const StringPool& pool, int id) {
+    string out;
+    int end = pool.offsets[id + 1];
+    for (int i = pool.offsets[id]; i < end; ++i) {
+        unsigned char c = (unsigned char)pool.data[i];
+        if (c == (unsigned char)POOL_ESCAPE && i + 1 < end) { out += pool.data[++i]; continue; }
+        if (c < 0x20 && pool.symbolOf[c] >= 0) { out += pool.symbols[pool.symbolOf[c]]; continue; }
+        out += (char)c;
     }
-    for (int i = 0; i < MAX_OPTIONS; ++i) q.options[i] = newOpts[i];
-    q.correctIndex = newCorrect;
+    return out;
+}
+
+void resetPool(StringPool& pool) {
+    pool.data.clear(); pool.count = 0; pool.offsets[0] = 0; pool.rawBytes = 0; pool.symbolCount = 0;
+    for (int c = 0; c < 32; ++c) pool.symbolOf[c] = -1;
+}
+
+// ---------- Tags ----------
+// Tag names are shared by all banks so a tag id means the same thing in every bank.
+const int MAX_TAGS = 32; // one bit each in HotEntry::tags
+
+struct TagRegistry {
+    string names[MAX_TAGS];
+    int count;
+};
+
+TagRegistry& tagRegistry() {
+    static TagRegistry r;
+    return r;
+}
+
+string lowerAscii(string s) {
+    for (size_t i = 0; i < s.size(); ++i) if (s[i] >= 'A' && s[i] <= 'Z') s[i] = (char)(s[i] - 'A' + 'a');
+    return s;
 }
 
-void apply5050(const Question& q, int visibleOptions[], int& visibleCount) {
-    int wrongs[3]; int wcount = 0;
-    for (int i = 0; i < MAX_OPTIONS; ++i) if (i != q.correctIndex) wrongs[wcount++] = i;
-    shuffleIntArray(wrongs, wcount);
-    visibleOptions[0] = q.correctIndex;
-    visibleOptions[1] = wrongs[0];   
-    visibleCount = 2;
-    if (visibleOptions[0] > visibleOptions[1]) { int t = visibleOptions[0]; visibleOptions[0] = visibleOptions[1]; visibleOptions[1] = t; }
+// Id of a tag (case-insensitive); registers new names when create is set. -1 if unknown or full.
+int tagId(const string& name, bool create) {
+    TagRegistry& r = tagRegistry();
+    string key = lowerAscii(name);
+    for (size_t i = 0; i < key.size(); ++i) if (key[i] == ' ') key[i] = '-'; // "Middle East" -> "middle-east", one query word
+    for (int t = 0; t < r.count; ++t) if (r.names[t] == key) return t;
+    if (!create || r.count >= MAX_TAGS || key.empty()) return -1;
+    r.names[r.count] = key;
+    return r.count++;
 }
 
-void displayQuestionWithVisibleOptions(const Question& q, const int visibleOptions[], int visibleCount) {
-    cout << "\n" << q.text << "\n";
-    for (int i = 0; i < MAX_OPTIONS; ++i) {
-        bool show = false;
-        for (int k = 0; k < visibleCount; ++k) if (visibleOptions[k] == i) { show = true; break; }
-        if (show) cout << i + 1 << ". " << q.options[i] << "\n"; else cout << i + 1 << ". ----\n";
+// "Europe, war" -> bitset of tag ids
+unsigned int parseTagList(const string& list) {
+    unsigned int bits = 0;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == string::npos) comma = list.size();
+        string name = list.substr(pos, comma - pos);
+        size_t b = name.find_first_not_of(' '), e = name.find_last_not_of(' ');
+        if (b != string::npos) {
+            int t = tagId(name.substr(b, e - b + 1), true);
+            if (t >= 0) bits |= 1u << t;
+        }
+        pos = comma + 1;
     }
+    return bits;
 }
 
-int readHighScores(const string& fn, ScoreEntry outScores[], int& outCount) {
-    outCount = 0; //0 scores read in start
-    ifstream fin(fn.c_str());
-    if (!fin.is_open()) return 0;
-    string line;
-    while (getline(fin, line)) {
-        if (line.empty()) continue;
-        size_t p1 = line.find('|');
-        size_t p2 = (p1 == string::npos) ? string::npos : line.find('|', p1 + 1);
-        if (p1 == string::npos || p2 == string::npos) continue;
-        ScoreEntry e;
-        e.name = line.substr(0, p1);
-        string sc = line.substr(p1 + 1, p2 - p1 - 1);//sc means write between first | and second |
-        try { e.score = stoi(sc); }
-        catch (...) { e.score = 0; }
-        e.datetime = line.substr(p2 + 1);
-        if (outCount < MAX_QUIZ_QUESTIONS) outScores[outCount++] = e;
+// ---------- Question banks ----------
+
+const unsigned char NO_CATEGORY = 0xFF;
+
+// Hot section: the fields sampling, filtering, scoring and replay need, 12 bytes per question
+// in one dense array. The question id is the array index.
+struct HotEntry {
+    unsigned int tags;          // bit t = tag id t
+    int answerKey;              // as Question::answerKey
+    unsigned char difficulty;
+    unsigned char category;     // index into CATEGORY_FILES, NO_CATEGORY for other files
+    unsigned char type;         // QUESTION_*
+    unsigned char optionCount;
+};
+
+// Cold section: where a question's text and notes live, needed only to display it.
+// A question takes 1 + optionCount consecutive text pool ids, so its size follows its
+// option count; display widths are stored per pool id alongside.
+struct ColdEntry {
+    int textId;                 // text pool id of the question text; option i is textId + 1 + i
+    int explanationId;          // notes pool ids, -1 if absent
+    int sourceId;
+};
+
+// A loaded bank file. Questions are addressed by bank index everywhere (decks, outcomes, logs),
+// never by address, so a bank's contents are the same wherever it ends up in memory.
+struct QuestionBank {
+    string file;
+    HotEntry hot[MAX_QUESTIONS];
+    ColdEntry cold[MAX_QUESTIONS];
+    StringPool text;  // question and option text
+    int textWidths[MAX_POOL_STRINGS]; // display width of each text pool string
+    StringPool notes; // explanations and sources; decoded only when shown after an answer
+    int count;
+    bool loaded;
+};
+
+// Category slot for a bank file name (paths allowed), NO_CATEGORY if it is not a category bank
+unsigned char categoryOfFile(const string& file) {
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        const string& name = CATEGORY_FILES[c];
+        if (file.size() >= name.size() && file.compare(file.size() - name.size(), name.size(), name) == 0 &&
+            (file.size() == name.size() || file[file.size() - name.size() - 1] == '/' || file[file.size() - name.size() - 1] == '\\'))
+            return (unsigned char)c;
     }
-    fin.close();
-    return outCount;
+    return NO_CATEGORY;
 }
 
-void writeHighScore(const string& fn, const ScoreEntry& entry) {
-    ofstream fout(fn.c_str(), ios::app);
-    if (!fout.is_open()) return;
-    fout << entry.name << "|" << entry.score << "|" << entry.datetime << "\n";
-    fout.close();
+// Compress parsed questions into a bank
+void compileBank(const Question questions[], const QuestionMeta meta[], int count, QuestionBank& bank) {
+    static string texts[MAX_POOL_STRINGS];
+    int textCount = 0;
+    for (int i = 0; i < count; ++i) {
+        texts[textCount++] = questions[i].text;
+        for (int o = 0; o < questions[i].optionCount; ++o) texts[textCount++] = questions[i].options[o];
+    }
+    StringPool& pool = bank.text;
+    resetPool(pool);
+    trainPoolSymbols(pool, texts, textCount);
+    int noteCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!meta[i].explanation.empty()) texts[noteCount++] = meta[i].explanation;
+        if (!meta[i].source.empty()) texts[noteCount++] = meta[i].source;
+    }
+    resetPool(bank.notes);
+    trainPoolSymbols(bank.notes, texts, noteCount);
+    unsigned char category = categoryOfFile(bank.file);
+    for (int i = 0; i < count; ++i) {
+        HotEntry& h = bank.hot[i];
+        ColdEntry& c = bank.cold[i];
+        h.difficulty = (unsigned char)questions[i].difficulty;
+        h.answerKey = questions[i].answerKey;
+        h.category = category;
+        h.type = (unsigned char)questions[i].type;
+        h.optionCount = (unsigned char)questions[i].optionCount;
+        h.tags = parseTagList(meta[i].tags);
+        c.textId = poolAdd(pool, questions[i].text);
+        bank.textWidths[c.textId] = questions[i].textWidth;
+        for (int o = 0; o < questions[i].optionCount; ++o) bank.textWidths[poolAdd(pool, questions[i].options[o])] = questions[i].optionWidths[o];
+        c.explanationId = meta[i].explanation.empty() ? -1 : poolAdd(bank.notes, meta[i].explanation);
+        c.sourceId = meta[i].source.empty() ? -1 : poolAdd(bank.notes, meta[i].source);
+    }
+    pool.data.shrink_to_fit();
+    bank.notes.data.shrink_to_fit();
+    bank.count = count;
 }
 
-void displayTopHighScores(const string& fn) {
-    ScoreEntry scores[MAX_QUIZ_QUESTIONS]; int sCount = 0;
-    readHighScores(fn, scores, sCount);
-    if (sCount == 0) { cout << "\nNo high scores yet.\n"; cout << "Press Enter to return to main menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return; }
-    // selection sort descending
-    for (int i = 0; i < sCount - 1; ++i) {
-        int best = i;
-        for (int j = i + 1; j < sCount; ++j) if (scores[j].score > scores[best].score) best = j;
-        if (best != i) { ScoreEntry t = scores[i]; scores[i] = scores[best]; scores[best] = t; }
+// Explanation and source of a question as one display line, "" if it has none
+string questionNotes(const QuestionBank& bank, int index) {
+    const ColdEntry& c = bank.cold[index];
+    string s;
+    if (c.explanationId >= 0) s = poolGet(bank.notes, c.explanationId);
+    if (c.sourceId >= 0) s += (s.empty() ? "" : " ") + string("(Source: ") + poolGet(bank.notes, c.sourceId) + ")";
+    return s;
+}
+
+// Decode one question of a bank, in bank option order
+void materializeQuestion(const QuestionBank& bank, int index, Question& q) {
+    const HotEntry& h = bank.hot[index];
+    const ColdEntry& e = bank.cold[index];
+    q.text = poolGet(bank.text, e.textId);
+    q.textWidth = bank.textWidths[e.textId];
+    q.type = h.type;
+    q.optionCount = h.optionCount;
+    for (int o = 0; o < q.optionCount; ++o) {
+        q.options[o] = poolGet(bank.text, e.textId + 1 + o);
+        q.optionWidths[o] = bank.textWidths[e.textId + 1 + o];
+        q.optionOrder[o] = o;
     }
-    cout << "\n================================\n        High Scores\n================================\n\n";
-    int show = (sCount < 5 ? sCount : 5);
-    for (int i = 0; i < show; ++i) cout << i + 1 << ". " << scores[i].name << " - " << scores[i].score << " points (" << scores[i].datetime << ")\n";
-    cout << "\nPress Enter to return to main menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    q.answerKey = h.answerKey;
+    q.correctIndex = (q.type == QUESTION_CHOICE) ? h.answerKey : 0;
+    q.correctMask = (q.type == QUESTION_MULTI) ? h.answerKey : 0;
+    q.difficulty = h.difficulty;
+    q.bankIndex = index;
 }
 
-void logSession(const string& fn, const QuizResult& r) {
-    ofstream fout(fn.c_str(), ios::app);
-    if (!fout.is_open()) return;
-    fout << "Player: " << r.playerName << " | Score: " << r.score << " | Correct: " << r.correct << " | Wrong: " << r.wrong << " | Time: " << nowString() << "\n";
-    fout << "Questions indices: ";
-    for (int i = 0; i < r.qCount; ++i) { fout << r.questionIndices[i] << (i + 1 == r.qCount ? "" : " ,"); }
-    fout << "\nAnswers: ";
-    for (int i = 0; i < r.qCount; ++i) { fout << r.answers[i] << (i + 1 == r.qCount ? "" : " ,"); }
-    fout << "\n-------------------------------\n";
-    fout.close();
+// Parse and compile a bank file; false if it has no loadable questions
+bool loadBank(const string& file, QuestionBank& bank) {
+    static Question parsed[MAX_QUESTIONS]; // parse scratch; loading happens on one thread
+    static QuestionMeta meta[MAX_QUESTIONS];
+    int count = 0;
+    bank.count = 0;
+    if (!loadQuestionsFromFile(file, parsed, meta, count)) return false;
+    compileBank(parsed, meta, count, bank);
+    return true;
 }
 
-// Save progress: we add an extra line for remaining seconds for the current question
-void saveProgress(const string& fn, const QuizResult& r) {
-    ofstream fout(fn.c_str());
-    if (!fout.is_open()) return;
-    fout << r.playerName << "\n";
-    fout << r.score << " " << r.correct << " " << r.wrong << " " << r.timestamp << "\n";
-    for (int i = 0; i < r.qCount; ++i) fout << r.answers[i] << " ";
-    fout << "\n";
-    for (int i = 0; i < r.qCount; ++i) fout << r.questionIndices[i] << " ";//Helps to know which questions to resume from.
-    fout << "\n";
-    fout << r.remainingSecondsForCurrent << "\n"; // new field; 0 means no saved time or finished
-    fout.close();
+// ---------- Question index ----------
+// Filtered quizzes draw from every category bank at once. There a question is named by a
+// global id, category * BANK_STRIDE + bank index, and every tag, difficulty and category has
+// a bitmap of the ids that carry it. Bitmaps are split into one container per category plus a
+// mask of the non-empty containers (roaring's layout with fixed-size containers), so AND/OR
+// only touch containers present on both sides.
+
+const int BANK_STRIDE = 512; // ids per category container, >= MAX_QUESTIONS
+const int CONTAINER_WORDS = BANK_STRIDE / 64;
+const int MAX_SOURCE_IDS = NUM_CATEGORIES * BANK_STRIDE;
+
+struct QuestionBitmap {
+    unsigned int containers; // bit c = container c is non-empty; words of empty containers are garbage
+    unsigned long long bits[NUM_CATEGORIES][CONTAINER_WORDS];
+};
+
+struct CatalogIndex {
+    QuestionBitmap byTag[MAX_TAGS];
+    QuestionBitmap byDifficulty[3];
+    QuestionBitmap byCategory[NUM_CATEGORIES];
+    bool indexed[NUM_CATEGORIES];
+};
+
+CatalogIndex& catalogIndex() {
+    static CatalogIndex idx;
+    return idx;
+}
+
+void bitmapSet(QuestionBitmap& b, int id) {
+    int c = id / BANK_STRIDE, bit = id % BANK_STRIDE;
+    if (!(b.containers & (1u << c))) {
+        for (int w = 0; w < CONTAINER_WORDS; ++w) b.bits[c][w] = 0;
+        b.containers |= 1u << c;
+    }
+    b.bits[c][bit / 64] |= 1ULL << (bit % 64);
+}
+
+// a &= b
+void bitmapAnd(QuestionBitmap& a, const QuestionBitmap& b) {
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        unsigned int m = 1u << c;
+        if (!(a.containers & m)) continue;
+        if (!(b.containers & m)) { a.containers &= ~m; continue; }
+        unsigned long long any = 0;
+        for (int w = 0; w < CONTAINER_WORDS; ++w) { a.bits[c][w] &= b.bits[c][w]; any |= a.bits[c][w]; }
+        if (!any) a.containers &= ~m;
+    }
+}
+
+// a |= b
+void bitmapOr(QuestionBitmap& a, const QuestionBitmap& b) {
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        unsigned int m = 1u << c;
+        if (!(b.containers & m)) continue;
+        if (a.containers & m) for (int w = 0; w < CONTAINER_WORDS; ++w) a.bits[c][w] |= b.bits[c][w];
+        else for (int w = 0; w < CONTAINER_WORDS; ++w) a.bits[c][w] = b.bits[c][w];
+        a.containers |= m;
+    }
+}
+
+// Write the ids in b to ids[] in ascending order; returns how many
+int bitmapToIds(const QuestionBitmap& b, int ids[]) {
+    int n = 0;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        if (!(b.containers & (1u << c))) continue;
+        for (int w = 0; w < CONTAINER_WORDS; ++w) {
+            unsigned long long word = b.bits[c][w];
+            for (int k = 0; word != 0; ++k, word >>= 1)
+                if (word & 1) ids[n++] = c * BANK_STRIDE + w * 64 + k;
+        }
+    }
+    return n;
+}
+
+// Add a freshly loaded category bank to the index (once per category)
+void indexCategoryBank(const QuestionBank& bank) {
+    unsigned char category = categoryOfFile(bank.file);
+    CatalogIndex& idx = catalogIndex();
+    if (category == NO_CATEGORY || idx.indexed[category]) return;
+    for (int i = 0; i < bank.count; ++i) {
+        const HotEntry& h = bank.hot[i];
+        int id = category * BANK_STRIDE + i;
+        bitmapSet(idx.byCategory[category], id);
+        bitmapSet(idx.byDifficulty[h.difficulty - 1], id);
+        for (int t = 0; t < MAX_TAGS; ++t) if (h.tags & (1u << t)) bitmapSet(idx.byTag[t], id);
+    }
+    idx.indexed[category] = true;
+}
+
+// All banks used by this process, loaded once on first use and then shared by every quiz,
+// room and replay. Static storage: a bank is far too big to copy onto the stack per quiz.
+struct Catalog {
+    QuestionBank banks[MAX_BANKS];
+    int bankCount;
+};
+
+Catalog& catalog() {
+    static Catalog c;
+    return c;
+}
+
+// Return the catalog slot for a bank file, loading it on first use; -1 if it cannot be loaded.
+int findOrLoadBank(const string& file) {
+    Catalog& c = catalog();
+    for (int b = 0; b < c.bankCount; ++b) {
+        if (c.banks[b].file != file) continue;
+        if (!c.banks[b].loaded && (c.banks[b].loaded = loadBank(file, c.banks[b]))) indexCategoryBank(c.banks[b]);
+        return c.banks[b].loaded ? b : -1;
+    }
+    if (c.bankCount >= MAX_BANKS) return -1;
+    QuestionBank& bank = c.banks[c.bankCount];
+    bank.file = file;
+    bank.loaded = loadBank(file, bank);
+    if (bank.loaded) indexCategoryBank(bank);
+    c.bankCount++; // keep the slot even on failure so a retry reuses it
+    return bank.loaded ? c.bankCount - 1 : -1;
+}
+
+// ---------- Filters ----------
+// "history AND europe AND difficulty:2 OR science": terms are category names, easy/medium/hard
+// or difficulty:N, and tags. AND binds tighter than OR; adjacent terms are ANDed.
+
+// Tag ids are assigned as banks load, so every category is loaded before a filter is read
+void loadAllCategoryBanks() {
+    for (int c = 0; c < NUM_CATEGORIES; ++c) findOrLoadBank(CATEGORY_FILES[c]);
+}
+
+// Bitmap of one lower-case query term; false if the term is unknown
+bool termBitmap(const string& term, QuestionBitmap& out) {
+    CatalogIndex& idx = catalogIndex();
+    int d = 0;
+    if (term == "easy") d = 1;
+    else if (term == "medium") d = 2;
+    else if (term == "hard") d = 3;
+    else if (term.compare(0, 11, "difficulty:") == 0 && (!parseStrictInt(term.substr(11), d) || d < 1 || d > 3)) return false;
+    if (d > 0) { out = idx.byDifficulty[d - 1]; return true; }
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        string stem = CATEGORY_FILES[c].substr(0, CATEGORY_FILES[c].find('.'));
+        if (term == lowerAscii(CATEGORY_NAMES[c]) || term == stem) { out = idx.byCategory[c]; return true; }
+    }
+    int t = tagId(term, false);
+    if (t < 0) return false;
+    out = idx.byTag[t];
+    return true;
+}
+
+// Evaluate a filter into result; false with a message in error if it does not parse
+bool evaluateFilter(const string& query, QuestionBitmap& result, string& error) {
+    loadAllCategoryBanks();
+    result.containers = 0;
+    QuestionBitmap group, term;
+    bool groupOpen = false, expectTerm = true;
+    size_t pos = 0;
+    while (true) {
+        size_t b = query.find_first_not_of(' ', pos);
+        if (b == string::npos) break;
+        size_t e = query.find(' ', b);
+        if (e == string::npos) e = query.size();
+        string tok = lowerAscii(query.substr(b, e - b));
+        pos = e;
+        if (tok == "and" || tok == "or") {
+            if (expectTerm) { error = "'" + tok + "' needs a term before it"; return false; }
+            if (tok == "or") { bitmapOr(result, group); groupOpen = false; }
+            expectTerm = true;
+            continue;
+        }
+        if (!termBitmap(tok, term)) { error = "unknown category, difficulty or tag '" + tok + "'"; return false; }
+        if (groupOpen) bitmapAnd(group, term);
+        else { group = term; groupOpen = true; }
+        expectTerm = false;
+    }
+    if (expectTerm) { error = pos > 0 ? "filter ends with an operator" : "empty filter"; return false; }
+    bitmapOr(result, group);
+    return true;
+}
+
+// Simple Fisher-Yates shuffle for int arrays
+void shuffleIntArray(int arr[], int n, QuizRng& rng) {
+    for (int i = n - 1; i > 0; --i) {
+        int j = rngBelow(rng, i + 1);
+        int tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp;
+    }
+}
+
+// Shuffle the N options of q (in bank order). N is a template parameter so every option
+// count, the common 4 included, gets fixed-size loops; shuffleOptions picks the instance.
+template <int N>
+void reorderOptionsN(Question& q, const int idx[]) {
+    string newOpts[N];
+    int newWidths[N];
+    int newCorrect = 0, newMask = 0;
+    for (int i = 0; i < N; ++i) {
+        newOpts[i].swap(q.options[idx[i]]);
+        newWidths[i] = q.optionWidths[idx[i]];
+        if (idx[i] == q.answerKey) newCorrect = i;
+        if (q.answerKey & (1 << idx[i])) newMask |= 1 << i;
+    }
+    for (int i = 0; i < N; ++i) { q.options[i].swap(newOpts[i]); q.optionWidths[i] = newWidths[i]; q.optionOrder[i] = idx[i]; }
+    if (q.type == QUESTION_CHOICE) q.correctIndex = newCorrect;
+    if (q.type == QUESTION_MULTI) q.correctMask = newMask;
+}
+
+template <int N>
+void shuffleOptionsN(Question& q, QuizRng& rng) {
+    int idx[N];
+    for (int i = 0; i < N; ++i) idx[i] = i;
+    shuffleIntArray(idx, N, rng);
+    reorderOptionsN<N>(q, idx);
+}
+
+// Put q (in bank order) into a known shown order: idx[i] is the bank option shown at i.
+// Returns false when idx is not a permutation of q's options.
+bool applyOptionOrder(Question& q, const int idx[]) {
+    int seen = 0;
+    for (int i = 0; i < q.optionCount; ++i) {
+        if (idx[i] < 0 || idx[i] >= q.optionCount || (seen & (1 << idx[i]))) return false;
+        seen |= 1 << idx[i];
+    }
+    switch (q.optionCount) {
+    case 2: reorderOptionsN<2>(q, idx); break;
+    case 3: reorderOptionsN<3>(q, idx); break;
+    case 4: reorderOptionsN<4>(q, idx); break;
+    case 5: reorderOptionsN<5>(q, idx); break;
+    case 6: reorderOptionsN<6>(q, idx); break;
+    default: break;
+    }
+    return true;
+}
+
+// Expects q in bank order (as loaded). Numeric questions have nothing to shuffle.
+void shuffleOptions(Question& q, QuizRng& rng) {
+    switch (q.optionCount) {
+    case 2: shuffleOptionsN<2>(q, rng); break;
+    case 3: shuffleOptionsN<3>(q, rng); break;
+    case 4: shuffleOptionsN<4>(q, rng); break;
+    case 5: shuffleOptionsN<5>(q, rng); break;
+    case 6: shuffleOptionsN<6>(q, rng); break;
+    default: break;
+    }
+}
+
+// Can a mode ask this question? Rooms answer with one key per seat, four keys per row.
+bool modeAllows(int mode, const HotEntry& h) {
+    return mode != MODE_ROOM || (h.type == QUESTION_CHOICE && h.optionCount <= 4);
+}
+
+// Draw a quiz deck: bank indices of up to 10 questions of the chosen difficulty
+// (falling back to the whole bank when fewer than 10 match) that the mode can ask.
+// Returns the deck size. Same bank + same seed + same mode always gives the same deck,
+// which is what replay relies on.
+int buildQuizDeck(const QuestionBank& bank, int diff, int mode, QuizRng& rng, int deck[]) {
+    int pool[MAX_QUESTIONS]; int poolCount = 0;
+    for (int i = 0; i < bank.count; ++i) if (bank.hot[i].difficulty == diff && modeAllows(mode, bank.hot[i])) pool[poolCount++] = i;
+    if (poolCount < 10) { poolCount = 0; for (int i = 0; i < bank.count; ++i) if (modeAllows(mode, bank.hot[i])) pool[poolCount++] = i; }
+    shuffleIntArray(pool, poolCount, rng);
+    int quizCount = poolCount > 10 ? 10 : poolCount;
+    for (int i = 0; i < quizCount; ++i) deck[i] = pool[i];
+    return quizCount;
+}
+
+// ---------- Question sources ----------
+// A quiz draws from a source: a bank file, or "filter:<query>" over all category banks.
+// Question ids (decks, outcomes, logs) are bank indices for a file and global ids for a filter.
+
+const string FILTER_PREFIX = "filter:";
+
+bool isFilterSource(const string& source) {
+    return source.compare(0, FILTER_PREFIX.size(), FILTER_PREFIX) == 0;
+}
+
+// A filter matching every category; its ids are the global ids
+string allCategoriesSource() {
+    string q;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) q += (c > 0 ? " OR " : "") + CATEGORY_FILES[c].substr(0, CATEGORY_FILES[c].find('.'));
+    return FILTER_PREFIX + q;
+}
+
+// Global id of a question id from a source; -1 if the source is not a category or filter
+int globalQuestionId(const string& source, int id) {
+    if (isFilterSource(source)) return (id >= 0 && id < MAX_SOURCE_IDS) ? id : -1;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) if (CATEGORY_FILES[c] == source) return (id >= 0 && id < BANK_STRIDE) ? c * BANK_STRIDE + id : -1;
+    return -1;
+}
+
+// Every question id the source can draw, ascending; -1 if the bank or filter is unusable
+int sourceQuestionIds(const string& source, int ids[]) {
+    if (isFilterSource(source)) {
+        QuestionBitmap matches; string error;
+        if (!evaluateFilter(source.substr(FILTER_PREFIX.size()), matches, error)) return -1;
+        return bitmapToIds(matches, ids);
+    }
+    int slot = findOrLoadBank(source);
+    if (slot < 0) return -1;
+    int n = catalog().banks[slot].count;
+    for (int i = 0; i < n; ++i) ids[i] = i;
+    return n;
+}
+
+// Bank slot and bank index of a question id; false if the id is not in the source
+bool resolveQuestion(const string& source, int id, int& slot, int& index) {
+    if (isFilterSource(source)) {
+        if (id < 0 || id >= MAX_SOURCE_IDS) return false;
+        slot = findOrLoadBank(CATEGORY_FILES[id / BANK_STRIDE]);
+        index = id % BANK_STRIDE;
+    }
+    else {
+        slot = findOrLoadBank(source);
+        index = id;
+    }
+    return slot >= 0 && index >= 0 && index < catalog().banks[slot].count;
+}
+
+// Decode a question by id; q.bankIndex holds the id
+void materializeSourceQuestion(const string& source, int id, Question& q) {
+    int slot = 0, index = 0;
+    if (!resolveQuestion(source, id, slot, index)) return;
+    materializeQuestion(catalog().banks[slot], index, q);
+    q.bankIndex = id;
+}
+
+// Deck for a source. Files use buildQuizDeck (difficulty applies); filters carry their own
+// difficulty terms and draw up to 10 of the matches with a partial shuffle, so the cost is
+// one bitmap scan however many questions match.
+int buildSourceDeck(const string& source, int diff, int mode, QuizRng& rng, int deck[]) {
+    if (!isFilterSource(source)) {
+        int slot = findOrLoadBank(source);
+        return slot < 0 ? 0 : buildQuizDeck(catalog().banks[slot], diff, mode, rng, deck);
+    }
+    static int ids[MAX_SOURCE_IDS];
+    int n = sourceQuestionIds(source, ids), kept = 0;
+    for (int i = 0; i < n; ++i) {
+        int slot = 0, index = 0;
+        if (resolveQuestion(source, ids[i], slot, index) && modeAllows(mode, catalog().banks[slot].hot[index])) ids[kept++] = ids[i];
+    }
+    n = kept;
+    int quizCount = n > 10 ? 10 : n;
+    for (int i = 0; i < quizCount; ++i) {
+        int j = i + rngBelow(rng, n - i);
+        int tmp = ids[i]; ids[i] = ids[j]; ids[j] = tmp;
+        deck[i] = ids[i];
+    }
+    return quizCount < 0 ? 0 : quizCount;
+}
+
+// Option visibility is a bitmask: bit i = shown option i is on screen
+const int ALL_OPTIONS_VISIBLE = (1 << MAX_OPTIONS) - 1;
+
+// ---------- Deck cache ----------
+// Classic quizzes of one (category, difficulty) redo the same pool scan and shuffle every
+// time. Decks for those specs are drawn ahead at idle points (while the main menu waits for
+// input) into a small ring per spec, so starting a quiz pops one. Each entry keeps its seed
+// and the RNG state after the draw: a popped deck continues exactly as a fresh draw would,
+// and replay rebuilds it from the logged seed.
+
+const int DECK_CACHE_DEPTH = 4;         // decks kept per spec
+const int DECK_CACHE_REFILL_BUDGET = 8; // decks drawn per idle point
+const int DECK_CACHE_SPECS = NUM_CATEGORIES * 3;
+
+struct CachedDeck {
+    unsigned int seed;
+    unsigned int rngState; // after the draw
+    int count;
+    int deck[MAX_QUIZ_QUESTIONS];
+};
+
+struct DeckRing {
+    CachedDeck decks[DECK_CACHE_DEPTH];
+    int head;     // oldest deck
+    int size;
+    int requests; // quizzes started with this spec, for refill order
+};
+
+struct DeckCache {
+    DeckRing rings[DECK_CACHE_SPECS];
+    int hits, misses;
+};
+
+DeckCache& deckCache() {
+    static DeckCache c;
+    return c;
+}
+
+// Ring index for a category file and difficulty 1-3; -1 for anything else (filters)
+int deckSpec(const string& source, int diff) {
+    if (diff < 1 || diff > 3) return -1;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) if (CATEGORY_FILES[c] == source) return c * 3 + diff - 1;
+    return -1;
+}
+
+// Deck for a classic quiz: a cached one when the spec has any (seed and rng are replaced by
+// the deck's), otherwise drawn now from rng, already seeded with seed.
+int takeQuizDeck(const string& source, int diff, unsigned int& seed, QuizRng& rng, int deck[]) {
+    DeckCache& c = deckCache();
+    int spec = deckSpec(source, diff);
+    if (spec >= 0) {
+        DeckRing& ring = c.rings[spec];
+        ring.requests++;
+        if (ring.size > 0) {
+            const CachedDeck& d = ring.decks[ring.head];
+            ring.head = (ring.head + 1) % DECK_CACHE_DEPTH; ring.size--;
+            seed = d.seed; rng.state = d.rngState;
+            for (int i = 0; i < d.count; ++i) deck[i] = d.deck[i];
+            c.hits++;
+            return d.count;
+        }
+        c.misses++;
+    }
+    return buildSourceDeck(source, diff, MODE_SOLO, rng, deck);
+}
+
+// Top up the rings of banks that are already loaded (idle time does no file I/O), most
+// requested spec first; draws at most 'budget' decks and returns how many it drew.
+int refillDeckCache(int budget) {
+    DeckCache& c = deckCache();
+    bool loaded[NUM_CATEGORIES];
+    for (int k = 0; k < NUM_CATEGORIES; ++k) {
+        loaded[k] = false;
+        for (int b = 0; b < catalog().bankCount; ++b) if (catalog().banks[b].file == CATEGORY_FILES[k] && catalog().banks[b].loaded) loaded[k] = true;
+    }
+    int drawn = 0;
+    while (drawn < budget) {
+        int best = -1;
+        for (int s = 0; s < DECK_CACHE_SPECS; ++s) {
+            if (!loaded[s / 3] || c.rings[s].size >= DECK_CACHE_DEPTH) continue;
+            if (best < 0 || c.rings[s].requests > c.rings[best].requests) best = s;
+        }
+        if (best < 0) break;
+        DeckRing& ring = c.rings[best];
+        CachedDeck& d = ring.decks[(ring.head + ring.size) % DECK_CACHE_DEPTH];
+        d.seed = makeSessionSeed();
+        QuizRng rng; rngSeed(rng, d.seed);
+        d.count = buildSourceDeck(CATEGORY_FILES[best / 3], best % 3 + 1, MODE_SOLO, rng, d.deck);
+        d.rngState = rng.state;
+        ring.size++;
+        drawn++;
+    }
+    return drawn;
+}
+
+// ---------- Streaming sampler ----------
+// Draws positions 0..n-1 without replacement one at a time: Fisher-Yates run lazily, where
+// only positions displaced by earlier draws are remembered. A draw is O(1) and memory grows
+// with the draws made, not with n, so a survival run never shuffles its whole pool.
+
+const int SAMPLER_SLOTS = 8192; // power of two, over twice MAX_SOURCE_IDS
+
+struct StreamSampler {
+    int n;
+    int drawn;
+    int keys[SAMPLER_SLOTS];   // displaced position, -1 for an empty slot
+    int values[SAMPLER_SLOTS]; // what now sits at that position
+    QuizRng rng;               // own stream, so replay can redraw it without the quiz's other draws
+};
+
+void samplerStart(StreamSampler& s, int n, unsigned int seed) {
+    s.n = n; s.drawn = 0;
+    for (int i = 0; i < SAMPLER_SLOTS; ++i) s.keys[i] = -1;
+    rngSeed(s.rng, seed ^ 0x5BD1E995u);
+}
+
+// Hash slot holding pos, or the empty slot where it would go
+int samplerSlot(const StreamSampler& s, int pos) {
+    unsigned int h = ((unsigned int)pos * 2654435761u) & (SAMPLER_SLOTS - 1);
+    while (s.keys[h] != -1 && s.keys[h] != pos) h = (h + 1) & (SAMPLER_SLOTS - 1);
+    return (int)h;
+}
+
+// Next position, -1 once all n have been drawn
+int samplerNext(StreamSampler& s) {
+    if (s.drawn >= s.n) return -1;
+    int j = s.drawn + rngBelow(s.rng, s.n - s.drawn);
+    int sj = samplerSlot(s, j), si = samplerSlot(s, s.drawn);
+    int atJ = (s.keys[sj] == j) ? s.values[sj] : j;
+    int atI = (s.keys[si] == s.drawn) ? s.values[si] : s.drawn;
+    // position 'drawn' is never read again; j takes over what was there
+    if (j != s.drawn) { s.keys[sj] = j; s.values[sj] = atI; }
+    s.drawn++;
+    return atJ;
+}
+
+// 50/50: hide every wrong option but one. Returns false (nothing hidden, no random draw)
+// when there is nothing to remove: numeric questions and choices with only two options.
+bool apply5050(const Question& q, int& visibleMask, QuizRng& rng) {
+    if (q.type == QUESTION_NUMERIC) return false;
+    int keep = (q.type == QUESTION_MULTI) ? q.correctMask : (1 << q.correctIndex);
+    int wrongs[MAX_OPTIONS]; int wcount = 0;
+    for (int i = 0; i < q.optionCount; ++i) if (!(keep & (1 << i))) wrongs[wcount++] = i;
+    if (wcount < 2) return false;
+    shuffleIntArray(wrongs, wcount, rng);
+    visibleMask = keep | (1 << wrongs[0]);
+    return true;
+}
+
+// A question block rendered to text once. Every redraw, and every player in a room,
+// prints these same strings; a viewer with hidden options (50/50) only swaps the
+// hidden lines for their "----" placeholders.
+struct QuestionFrame {
+    int optionCount;
+    string header;                   // banner, question number, text and how to answer
+    string optionLines[MAX_OPTIONS];
+    string hiddenLines[MAX_OPTIONS];
+    string full;                     // header + all option lines, written in one go
+};
+
+// Append prefix + text wrapped at FRAME_WIDTH columns, continuation lines indented under the text.
+// width is text's precomputed display width: text that fits (nearly all of it) is appended
+// without looking at its characters; only overlong text is measured word by word.
+void appendWrapped(string& out, const string& prefix, const string& text, int width) {
+    int indent = (int)prefix.size(); // prefixes are ASCII
+    if (indent + width <= FRAME_WIDTH) { out += prefix + text + "\n"; return; }
+    out += prefix;
+    int col = indent;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t sp = text.find(' ', pos);
+        size_t end = (sp == string::npos) ? text.size() : sp;
+        string word = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (word.empty()) continue;
+        int w = displayWidth(word);
+        if (col > indent && col + 1 + w > FRAME_WIDTH) { out += "\n" + string(indent, ' '); col = indent; }
+        else if (col > indent) { out += " "; col++; }
+        out += word; col += w;
+    }
+    out += "\n";
+}
+
+void renderQuestionFrame(const Question& q, int number, QuestionFrame& f) {
+    f.header = "\n================================\nQuestion " + to_string(number) + " (Difficulty " + to_string(q.difficulty) + ")\n\n";
+    appendWrapped(f.header, "", q.text, q.textWidth);
+    if (q.type == QUESTION_MULTI) f.header += "(Select all that apply)\n";
+    f.optionCount = q.optionCount;
+    f.full = f.header;
+    for (int i = 0; i < q.optionCount; ++i) {
+        f.optionLines[i].clear();
+        appendWrapped(f.optionLines[i], to_string(i + 1) + ". ", q.options[i], q.optionWidths[i]);
+        f.hiddenLines[i] = to_string(i + 1) + ". ----\n";
+        f.full += f.optionLines[i];
+    }
+}
+
+// Print a question's explanation/source after it has been answered (cold data, decoded here)
+void displayQuestionNotes(const string& source, int id) {
+    int slot = 0, index = 0;
+    if (!resolveQuestion(source, id, slot, index)) return;
+    string notes = questionNotes(catalog().banks[slot], index);
+    if (notes.empty()) return;
+    string out;
+    appendWrapped(out, "Why: ", notes, displayWidth(notes));
+    cout << out;
+}
+
+void displayQuestionFrame(const QuestionFrame& f, int visibleMask) {
+    int all = (1 << f.optionCount) - 1;
+    if ((visibleMask & all) == all) { cout << f.full; return; }
+    cout << f.header;
+    for (int i = 0; i < f.optionCount; ++i) cout << ((visibleMask & (1 << i)) ? f.optionLines[i] : f.hiddenLines[i]);
+}
+
+// How to answer q, shown under the question
+string answerPrompt(const Question& q) {
+    string keys = "1-" + to_string(q.optionCount);
+    if (q.type == QUESTION_NUMERIC) return "Type your answer and press Enter";
+    if (q.type == QUESTION_MULTI) return "Press " + keys + " to select or unselect options, Enter to submit";
+    return "Press " + keys + " to answer immediately";
+}
+
+// The correct answer as shown to the player
+string correctAnswerText(const Question& q) {
+    if (q.type == QUESTION_NUMERIC) return to_string(q.answerKey);
+    if (q.type == QUESTION_CHOICE) return q.options[q.correctIndex];
+    string s;
+    for (int i = 0; i < q.optionCount; ++i) if (q.correctMask & (1 << i)) s += (s.empty() ? "" : ", ") + q.options[i];
+    return s;
+}
+
+// A shown answer (option number, shown-option mask or value) in bank terms, for the outcome record
+int bankAnswerFor(const Question& q, int answer) {
+    if (q.type == QUESTION_NUMERIC) return answer;
+    if (q.type == QUESTION_CHOICE) return q.optionOrder[answer - 1] + 1;
+    int mask = 0;
+    for (int i = 0; i < q.optionCount; ++i) if (answer & (1 << i)) mask |= 1 << q.optionOrder[i];
+    return mask;
+}
+
+// Does a bank-order answer (see QuestionOutcome::bankAnswer) match the answer key?
+bool answerMatches(int type, int answerKey, int bankAnswer) {
+    if (type == QUESTION_CHOICE) return bankAnswer - 1 == answerKey;
+    return bankAnswer == answerKey; // the whole option set (multi-select) or the value (numeric)
+}
+
+// "name|score|datetime"
+bool parseScoreLine(const string& line, ScoreEntry& e) {
+    size_t p1 = line.find('|');
+    size_t p2 = (p1 == string::npos) ? string::npos : line.find('|', p1 + 1);
+    if (p1 == string::npos || p2 == string::npos) return false;
+    e.name = line.substr(0, p1);
+    string sc = line.substr(p1 + 1, p2 - p1 - 1);//sc means write between first | and second |
+    try { e.score = stoi(sc); }
+    catch (...) { e.score = 0; }
+    e.datetime = line.substr(p2 + 1);
+    return true;
+}
+
+int readHighScores(const string& fn, ScoreEntry outScores[], int& outCount) {
+    outCount = 0; //0 scores read in start
+    flushAppends(fn);
+    ifstream fin(fn.c_str());
+    if (!fin.is_open()) return 0;
+    string line;
+    while (getline(fin, line)) {
+        if (line.empty()) continue;
+        ScoreEntry e;
+        if (!parseScoreLine(line, e)) continue;
+        if (outCount < MAX_QUIZ_QUESTIONS) outScores[outCount++] = e;
+    }
+    fin.close();
+    return outCount;
+}
+
+void writeHighScore(const string& fn, const ScoreEntry& entry) {
+    queueAppend(fn, entry.name + "|" + to_string(entry.score) + "|" + entry.datetime + "\n");
+}
+
+void displayTopHighScores(const string& fn) {
+    ScoreEntry scores[MAX_QUIZ_QUESTIONS]; int sCount = 0;
+    readHighScores(fn, scores, sCount);
+    if (sCount == 0) { cout << "\nNo high scores yet.\n"; cout << "Press Enter to return to main menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return; }
+    // selection sort descending
+    for (int i = 0; i < sCount - 1; ++i) {
+        int best = i;
+        for (int j = i + 1; j < sCount; ++j) if (scores[j].score > scores[best].score) best = j;
+        if (best != i) { ScoreEntry t = scores[i]; scores[i] = scores[best]; scores[best] = t; }
+    }
+    cout << "\n================================\n        High Scores\n================================\n\n";
+    int show = (sCount < 5 ? sCount : 5);
+    for (int i = 0; i < show; ++i) cout << i + 1 << ". " << scores[i].name << " - " << scores[i].score << " points (" << scores[i].datetime << ")\n";
+    cout << "\nPress Enter to return to main menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+// Outcome records serialize as "index:bankIndex:answer:bankAnswer:kind:difficulty:remainingMs:points"
+// separated by spaces
+string formatOutcomes(const QuizResult& r) {
+    string s;
+    for (int i = 0; i < r.qCount; ++i) {
+        const QuestionOutcome& o = outcomeAt(r, i);
+        char buf[128];
+        snprintf(buf, sizeof(buf), "%d:%d:%d:%d:%d:%d:%d:%d", o.questionIndex, o.bankIndex, o.answer, o.bankAnswer, o.kind, o.difficulty, o.remainingMs, o.points);
+        if (i > 0) s += " ";
+        s += buf;
+    }
+    return s;
+}
+
+// Parse a formatOutcomes() line, appending the records to r; returns the number read.
+// Bonus fields are not stored: they are recomputed when outcomes are re-applied.
+int parseOutcomes(const string& line, QuizResult& r) {
+    int count = 0;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        size_t end = line.find(' ', pos);
+        if (end == string::npos) end = line.size();
+        string tok = line.substr(pos, end - pos);
+        pos = end + 1;
+        if (tok.empty()) continue;
+        QuestionOutcome o;
+        if (sscanf(tok.c_str(), "%d:%d:%d:%d:%d:%d:%d:%d", &o.questionIndex, &o.bankIndex, &o.answer, &o.bankAnswer, &o.kind, &o.difficulty, &o.remainingMs, &o.points) != 8) break;
+        o.streakBonus = 0; o.speedBonus = 0;
+        if (!appendOutcome(r, o)) break;
+        count++;
+    }
+    return count;
+}
+
+void logSession(const string& fn, const QuizResult& r) {
+    ostringstream fout;
+    fout << "Player: " << r.playerName << " | Score: " << r.score << " | Correct: " << r.correct << " | Wrong: " << r.wrong << " | Time: " << nowString() << "\n";
+    fout << "Session: " << r.seed << " | Category: " << r.categoryFile << " | Difficulty: " << r.difficulty << " | Speed: " << (r.speedMode ? 1 : 0) << " | Mode: " << MODE_NAMES[r.mode] << "\n";
+    fout << "Questions indices: ";
+    for (int i = 0; i < r.qCount; ++i) { fout << outcomeAt(r, i).questionIndex << (i + 1 == r.qCount ? "" : " ,"); }
+    fout << "\nAnswers: ";
+    for (int i = 0; i < r.qCount; ++i) { fout << outcomeAt(r, i).answer << (i + 1 == r.qCount ? "" : " ,"); }
+    fout << "\nOutcomes: " << formatOutcomes(r);
+    fout << "\n-------------------------------\n";
+    queueAppend(fn, fout.str());
+}
+
+// Save progress: we add an extra line for remaining seconds for the current question
+string formatProgress(const QuizResult& r) {
+    ostringstream fout;
+    fout << r.playerName << "\n";
+    fout << r.score << " " << r.correct << " " << r.wrong << " " << r.timestamp << "\n";
+    for (int i = 0; i < r.qCount; ++i) fout << outcomeAt(r, i).answer << " ";
+    fout << "\n";
+    for (int i = 0; i < r.qCount; ++i) fout << outcomeAt(r, i).questionIndex << " ";//Helps to know which questions to resume from.
+    fout << "\n";
+    fout << r.remainingSecondsForCurrent << "\n"; // new field; 0 means no saved time or finished
+    fout << formatOutcomes(r) << "\n"; // full outcome records (replaces the two lines above when present)
+    return fout.str();
+}
+
+// Load progress: this version accepts both old and new formats.
+// If the text contains the extra line (remaining seconds), it will be read; otherwise default to DEFAULT_TIME_PER_QUESTION.
+// If it also contains the outcome line, the outcome records are restored from it.
+bool readProgress(istream& fin, QuizResult& r) {
+    initOutcomes(r); // r is expected fresh; the caller releases its outcomes
+    if (!getline(fin, r.playerName)) return false;
+    string line;
+    if (!getline(fin, line)) return false;
+    int sc = 0, cr = 0, wr = 0; long long ts = 0;
+    if (sscanf(line.c_str(), "%d %d %d %lld", &sc, &cr, &wr, &ts) < 4) return false;
+    r.score = sc; r.correct = cr; r.wrong = wr; r.timestamp = (time_t)ts;
+    if (!getline(fin, line)) return false;
+    // parse answers
+    const char* p = line.c_str();
+    int val;
+    while (sscanf(p, "%d", &val) == 1) {
+        QuestionOutcome o;
+        o.questionIndex = 0; o.bankIndex = 0; o.answer = val; o.bankAnswer = 0; o.kind = 0; o.difficulty = 0;
+        o.remainingMs = 0; o.points = 0; o.streakBonus = 0; o.speedBonus = 0;
+        if (!appendOutcome(r, o)) break;
+        // advance p
+        const char* sp = p;
+        while (*sp != '\0' && *sp != ' ') ++sp;
+        if (*sp == '\0') break;
+        p = sp + 1;
+    }
+    if (!getline(fin, line)) return false;
+    // question indices
+    {
+        const char* q = line.c_str();
+        int qi; int idx = 0;
+        while (sscanf(q, "%d", &qi) == 1) {
+            if (idx < r.qCount) outcomeAt(r, idx).questionIndex = qi;
+            idx++;
+            const char* sp = q;
+            while (*sp != '\0' && *sp != ' ') ++sp;
+            if (*sp == '\0') break;
+            q = sp + 1;
+        }
+        // clamp qCount if needed
+        truncateOutcomes(r, idx);
+    }
+    // try read remaining seconds line (optional)
+    if (getline(fin, line)) {
+        try {
+            r.remainingSecondsForCurrent = stoi(line);
+            if (r.remainingSecondsForCurrent < 0) r.remainingSecondsForCurrent = 0;
+        }
+        catch (...) { r.remainingSecondsForCurrent = DEFAULT_TIME_PER_QUESTION; }
+    }
+    else {
+        // older save format: assume full time for next question
+        r.remainingSecondsForCurrent = DEFAULT_TIME_PER_QUESTION;
+    }
+    if (getline(fin, line)) {
+        QuizResult parsed; initOutcomes(parsed);
+        int n = parseOutcomes(line, parsed);
+        if (n == r.qCount) for (int i = 0; i < n; ++i) outcomeAt(r, i) = outcomeAt(parsed, i);
+        releaseOutcomes(parsed);
+    }
+    return true;
+}
+
+// get a single non-blocking keypress if available; returns '\0' if none.
+// Uses _kbhit() / _getch() from conio.h
+char getNonBlockingKey() {
+    if (_kbhit()) {
+        int ch = _getch();
+        if (ch == 0 || ch == 224) { // extended key prefix; read and ignore following
+            if (_kbhit()) _getch();
+            return '\0';
+        }
+        return (char)ch;
+    }
+    return '\0';
+}
+
+// small pause to avoid busy spinning while polling for keys
+// (we avoid <thread> and <chrono>; we'll approximate with a short loop)
+void idlePause() {
+    // Do a crude busy wait with a quick for-loop to yield CPU briefly.
+    for (int spin = 0; spin < 20000; ++spin) {
+        // small no-op to yield CPU; this keeps the loop lightweight without threads/chrono.
+        // On modern machines this is enough to avoid burning CPU too hard while still responsive.
+        // If you want a better sleep, platform-specific Sleep(ms) from windows.h can be used.
+        volatile int x = spin * spin;
+        (void)x;
+        // check if a key became available to break sooner
+        if (_kbhit()) break;
+    }
+}
+
+// Display remaining seconds on same line (format: Time Remaining: 08s), followed by
+// suffix (what has been entered so far on multi-select and numeric questions)
+void showRemainingSecondsLine(int rem, const string& suffix) {
+    cout << "\rTime Remaining: " << (rem < 10 ? "0" : "") << rem << "s  " << suffix << flush;
+}
+
+// The entry suffix for showRemainingSecondsLine; empty for choice questions
+string answerEntryText(const Question& q, int selectedMask, const string& typed) {
+    if (q.type == QUESTION_CHOICE) return "";
+    string s = "Answer: ";
+    if (q.type == QUESTION_NUMERIC) s += typed;
+    else for (int i = 0; i < q.optionCount; ++i) if (selectedMask & (1 << i)) s += to_string(i + 1) + " ";
+    return s + "          "; // blanks over a longer previous entry
+}
+
+// Whole seconds shown to the player for a millisecond budget (rounded up so 0.4s shows as 01s)
+int msToDisplaySeconds(int ms) {
+    if (ms <= 0) return 0;
+    return (ms + 999) / 1000;
+}
+
+int basePointsFor(int difficulty) {
+    return (difficulty == 1 ? 10 : (difficulty == 2 ? 15 : 20));
+}
+
+// Speed bonus for a correct answer: scales linearly with time left on the standard clock.
+// Integer-only so every platform computes the same score for the same latency.
+// Time gained from ExtraTime does not count toward the bonus.
+int speedBonus(int basePoints, int remainingMs) {
+    const int fullMs = DEFAULT_TIME_PER_QUESTION * 1000;
+    if (remainingMs <= 0) return 0;
+    if (remainingMs > fullMs) remainingMs = fullMs;
+    return (int)((long long)basePoints * SPEED_BONUS_MAX_PERCENT * remainingMs / (100LL * fullMs));
+}
+
+int penaltyFor(int difficulty) {
+    return (difficulty == 1 ? 2 : (difficulty == 2 ? 3 : 5));
+}
+
+// Apply one outcome to the running totals and record its score change in o.points.
+// This is the only place the score changes, so a saved or logged list of outcomes
+// can be re-applied from an empty ScoreState to reproduce the totals.
+void applyOutcome(ScoreState& st, QuestionOutcome& o, bool speedMode) {
+    o.points = 0; o.streakBonus = 0; o.speedBonus = 0;
+    if (o.kind == OUTCOME_CORRECT) {
+        st.correct++; st.streak++;
+        if (st.streak == 3) o.streakBonus = 5;
+        else if (st.streak == 5) o.streakBonus = 15;
+        int base = basePointsFor(o.difficulty);
+        if (speedMode) o.speedBonus = speedBonus(base, o.remainingMs);
+        o.points = base + o.streakBonus + o.speedBonus;
+    }
+    else if (o.kind == OUTCOME_WRONG || o.kind == OUTCOME_TIMEOUT) {
+        st.wrong++; st.streak = 0;
+        o.points = -penaltyFor(o.difficulty);
+    }
+    // OUTCOME_SKIPPED: no penalty, streak kept
+    st.score += o.points;
+}
+
+// Lifelines still available in a quiz, one bit each
+const int LIFELINE_5050 = 1;
+const int LIFELINE_SKIP = 2;
+const int LIFELINE_REPLACE = 4;
+const int LIFELINE_EXTRA = 8;
+const int ALL_LIFELINES = 15;
+
+// The "Lifelines: ..." line for a set of available lifelines; all 16 lines are built once
+const string& lifelineBar(int lifelines) {
+    static string bars[ALL_LIFELINES + 1];
+    static bool built = false;
+    if (!built) {
+        for (int m = 0; m <= ALL_LIFELINES; ++m) {
+            bars[m] = "\nLifelines: ";
+            if (m & LIFELINE_5050) bars[m] += "[1]50/50 ";
+            if (m & LIFELINE_SKIP) bars[m] += "[2]Skip ";
+            if (m & LIFELINE_REPLACE) bars[m] += "[3]Replace ";
+            if (m & LIFELINE_EXTRA) bars[m] += "[4]ExtraTime ";
+        }
+        built = true;
+    }
+    return bars[lifelines & ALL_LIFELINES];
+}
+
+// Survival and blitz draw questions one at a time from a StreamSampler instead of a deck
+bool isStreamedMode(int mode) { return mode == MODE_SURVIVAL || mode == MODE_BLITZ; }
+
+// The next streamed question, drawn, option-shuffled and rendered before it is needed
+struct PreparedQuestion {
+    bool ready;
+    bool exhausted; // the sampler has nothing left
+    Question q;
+    QuestionFrame frame;
+};
+
+void prepareStreamQuestion(const string& source, const int ids[], StreamSampler& s, QuizRng& rng, int number, PreparedQuestion& p) {
+    int pos = samplerNext(s);
+    if (pos < 0) { p.exhausted = true; return; }
+    materializeSourceQuestion(source, ids[pos], p.q);
+    shuffleOptions(p.q, rng);
+    renderQuestionFrame(p.q, number, p.frame);
+    p.ready = true;
+}
+
+// ---------- Daily challenge ----------
+// One quiz per calendar day, the same for every player: the deck is drawn once from a
+// date-derived seed, its questions are decoded, shuffled and rendered once, and every
+// daily game is served from that copy. DAILY_DECK_FILE pins the day's questions, option
+// order and answer key for later runs. It only stays valid while the bank agrees with it:
+// if a bank edit changes a pinned question's answer key, or drops the question, the file
+// is discarded and the day's deck is rebuilt from the edited bank, so players before and
+// after such an edit can play different decks on the same daily board.
+
+const string DAILY_DECK_FILE = "daily_deck.txt";
+const string DAILY_SCORE_FILE = "daily_scores.txt";
+
+struct DailyDeck {
+    int date;          // YYYYMMDD, 0 until built
+    unsigned int seed;
+    string source;
+    int count;
+    Question questions[MAX_QUIZ_QUESTIONS]; // shuffled; answer key in correctIndex/correctMask/answerKey
+    QuestionFrame frames[MAX_QUIZ_QUESTIONS];
+};
+
+DailyDeck& dailyDeck() {
+    static DailyDeck d;
+    return d;
+}
+
+int todayDate() {
+    time_t t = time(nullptr);
+    tm lt;
+    if (localtime_s(&lt, &t) != 0) return 0;
+    return (lt.tm_year + 1900) * 10000 + (lt.tm_mon + 1) * 100 + lt.tm_mday;
+}
+
+// Neighbouring dates must not give neighbouring seeds
+unsigned int dailySeed(int date) {
+    QuizRng r; rngSeed(r, (unsigned int)date * 2654435761u);
+    rngNext(r);
+    return rngNext(r);
+}
+
+// The answer key as shown: option index, shown-option mask or value
+int shownAnswerKey(const Question& q) {
+    if (q.type == QUESTION_CHOICE) return q.correctIndex;
+    if (q.type == QUESTION_MULTI) return q.correctMask;
+    return q.answerKey;
+}
+
+// Reload the day's deck from DAILY_DECK_FILE; false if it is for another day, unreadable,
+// or no longer matches the banks
+bool readDailyDeckFile(DailyDeck& d, int date) {
+    ifstream fin(DAILY_DECK_FILE.c_str());
+    if (!fin.is_open()) return false;
+    string line;
+    int fileDate = 0, count = 0; unsigned int seed = 0;
+    if (!getline(fin, line) || sscanf(line.c_str(), "Date: %d | Seed: %u", &fileDate, &seed) != 2 || fileDate != date) return false;
+    size_t ps = line.find("| Source: ");
+    if (ps == string::npos || line.substr(ps + 10) != d.source || seed != d.seed) return false;
+    while (count < MAX_QUIZ_QUESTIONS && getline(fin, line)) {
+        int id = 0, key = 0, order[MAX_OPTIONS] = { 0 };
+        if (sscanf(line.c_str(), "Question: %d | Key: %d | Order: %d %d %d %d %d %d", &id, &key, &order[0], &order[1], &order[2], &order[3], &order[4], &order[5]) < 2) return false;
+        Question& q = d.questions[count];
+        q.optionCount = -1;
+        materializeSourceQuestion(d.source, id, q);
+        if (q.optionCount < 0 || (q.optionCount > 0 && !applyOptionOrder(q, order)) || shownAnswerKey(q) != key) return false;
+        count++;
+    }
+    d.count = count;
+    return count > 0;
+}
+
+void writeDailyDeckFile(const DailyDeck& d) {
+    ofstream fout(DAILY_DECK_FILE.c_str());
+    if (!fout.is_open()) return;
+    fout << "Date: " << d.date << " | Seed: " << d.seed << " | Source: " << d.source << "\n";
+    for (int i = 0; i < d.count; ++i) {
+        const Question& q = d.questions[i];
+        fout << "Question: " << q.bankIndex << " | Key: " << shownAnswerKey(q) << " | Order:";
+        for (int k = 0; k < q.optionCount; ++k) fout << " " << q.optionOrder[k];
+        fout << "\n";
+    }
+    fout.close();
+}
+
+// Today's deck, built at most once per day per process. The seed alone reproduces the
+// question draw (replay rebuilds it with buildSourceDeck); the file keeps it fixed.
+bool prepareDailyDeck() {
+    DailyDeck& d = dailyDeck();
+    int date = todayDate();
+    if (d.date == date && d.count > 0) return true;
+    loadAllCategoryBanks();
+    d.date = 0; d.seed = dailySeed(date); d.source = allCategoriesSource(); // the daily draws from every category
+    if (!readDailyDeckFile(d, date)) {
+        QuizRng rng; rngSeed(rng, d.seed);
+        int deck[MAX_QUIZ_QUESTIONS];
+        d.count = buildSourceDeck(d.source, 0, MODE_DAILY, rng, deck);
+        for (int i = 0; i < d.count; ++i) { materializeSourceQuestion(d.source, deck[i], d.questions[i]); shuffleOptions(d.questions[i], rng); }
+        d.date = date;
+        if (d.count > 0) writeDailyDeckFile(d);
+    }
+    if (d.count <= 0) return false;
+    for (int i = 0; i < d.count; ++i) renderQuestionFrame(d.questions[i], i + 1, d.frames[i]);
+    d.date = date;
+    return true;
+}
+
+// Daily scores are "date|name|score|datetime"
+void writeDailyScore(const string& fn, int date, const ScoreEntry& entry) {
+    queueAppend(fn, to_string(date) + "|" + entry.name + "|" + to_string(entry.score) + "|" + entry.datetime + "\n");
+}
+
+// Top 5 for one date, kept sorted while the file streams past
+void displayDailyScores(const string& fn, int date) {
+    const int SHOW = 5;
+    ScoreEntry top[SHOW]; int topCount = 0, players = 0;
+    flushAppends(fn);
+    ifstream fin(fn.c_str());
+    string line, prefix = to_string(date) + "|";
+    while (fin.is_open() && getline(fin, line)) {
+        ScoreEntry e;
+        if (line.compare(0, prefix.size(), prefix) != 0 || !parseScoreLine(line.substr(prefix.size()), e)) continue;
+        players++;
+        int at = topCount;
+        while (at > 0 && top[at - 1].score < e.score) at--;
+        if (at >= SHOW) continue;
+        for (int k = (topCount < SHOW ? topCount : SHOW - 1); k > at; --k) top[k] = top[k - 1];
+        top[at] = e;
+        if (topCount < SHOW) topCount++;
+    }
+    cout << "\n================================\n   Daily Challenge " << date << "\n================================\n\n";
+    if (topCount == 0) cout << "No scores yet today.\n";
+    for (int i = 0; i < topCount; ++i) cout << i + 1 << ". " << top[i].name << " - " << top[i].score << " points (" << top[i].datetime << ")\n";
+    if (players > 0) cout << "(" << players << " games played today)\n";
+}
+
+// Where a finished quiz's score goes: the all-time board (date 0) or one day's daily board
+struct ScoreBoard {
+    string file;
+    int date;
+};
+
+void recordScore(const ScoreBoard& board, const ScoreEntry& e) {
+    if (board.date == 0) { writeHighScore(board.file, e); return; }
+    writeDailyScore(board.file, board.date, e);
+    displayDailyScores(board.file, board.date);
+}
+
+// ---------- Player store ----------
+// Everything kept per player (ratings, study queues) goes through one small log-structured
+// key-value store instead of a file per feature. A write appends to a log and lands in a
+// sorted in-memory table; a full table is written out as an immutable sorted segment with a
+// bloom filter and a sparse key index. A read checks the table, then the segments newest
+// first, skipping any whose bloom filter rules the key out, and reads at most KV_INDEX_EVERY
+// records of a segment. Segments are merged at idle points (the main menu), so a lookup
+// stays a few small reads however many players there are.
+//   KV_NAME.log       writes not yet in a segment, replayed at open
+//   KV_NAME.manifest  live segments, oldest first
+//   KV_NAME.<n>.seg   header ("QKV1", count, bloom bytes, end of records), bloom, records,
+//                     then (key length, key, record offset) for every KV_INDEX_EVERY-th record
+// A record is (key length, value length or -1 for a delete, key, value). All integers are
+// 4-byte little-endian.
+
+const string KV_NAME = "players.kv";
+const int KV_MEMTABLE_ENTRIES = 256;
+const int KV_MAX_SEGMENTS = 8;
+const int KV_COMPACT_AT = 4;       // segments that make an idle point merge them
+const int KV_INDEX_EVERY = 16;
+const int KV_BLOOM_BITS_PER_KEY = 10;
+const int KV_BLOOM_HASHES = 7;     // about 1% false positives at 10 bits per key
+const int KV_HEADER_BYTES = 16;
+
+void putInt32(string& out, int v) {
+    unsigned int u = (unsigned int)v;
+    for (int i = 0; i < 4; ++i) out += (char)((u >> (8 * i)) & 0xFF);
+}
+
+int getInt32(const string& in, size_t at) {
+    unsigned int u = 0;
+    for (int i = 0; i < 4; ++i) u |= (unsigned int)(unsigned char)in[at + i] << (8 * i);
+    return (int)u;
+}
+
+struct KvEntry {
+    string key;
+    string value;
+    bool deleted;
+};
+
+struct KvSegment {
+    int number;
+    int count;
+    int recordsEnd;
+    string bloom;
+    string indexKeys;  // the indexed keys, back to back
+    string indexSlots; // per indexed key: start in indexKeys, length, record offset
+    int indexCount;
+};
+
+struct KvStore {
+    bool opened;
+    KvEntry mem[KV_MEMTABLE_ENTRIES]; // sorted by key
+    int memCount;
+    KvSegment segs[KV_MAX_SEGMENTS];  // oldest first
+    int segCount;
+    int nextSegment;
+    int gets, segmentReads, bloomSkips, compactions;
+};
+
+KvStore& kvStore() {
+    static KvStore kv;
+    return kv;
+}
+
+string kvSegmentFile(int number) {
+    return KV_NAME + "." + to_string(number) + ".seg";
+}
+
+// FNV-1a
+unsigned int kvHash(const string& key, unsigned int seed) {
+    unsigned int h = 2166136261u ^ seed;
+    for (unsigned char ch : key) { h ^= ch; h *= 16777619u; }
+    return h;
+}
+
+// Bit positions by double hashing: h1 + i * h2
+void bloomAdd(string& bloom, const string& key) {
+    unsigned int bits = (unsigned int)bloom.size() * 8, h1 = kvHash(key, 0), h2 = kvHash(key, 0x9747B28Cu) | 1;
+    for (int i = 0; i < KV_BLOOM_HASHES; ++i) {
+        unsigned int b = (h1 + (unsigned int)i * h2) % bits;
+        bloom[b >> 3] = (char)(bloom[b >> 3] | (1 << (b & 7)));
+    }
+}
+
+bool bloomMayContain(const string& bloom, const string& key) {
+    unsigned int bits = (unsigned int)bloom.size() * 8, h1 = kvHash(key, 0), h2 = kvHash(key, 0x9747B28Cu) | 1;
+    for (int i = 0; i < KV_BLOOM_HASHES; ++i) {
+        unsigned int b = (h1 + (unsigned int)i * h2) % bits;
+        if (!(bloom[b >> 3] & (1 << (b & 7)))) return false;
+    }
+    return true;
+}
+
+void kvAppendRecord(string& out, const KvEntry& e) {
+    putInt32(out, (int)e.key.size());
+    putInt32(out, e.deleted ? -1 : (int)e.value.size());
+    out += e.key;
+    if (!e.deleted) out += e.value;
+}
+
+// Parse the record at 'at' and move past it; false at the end or on a torn record
+bool kvParseRecord(const string& data, size_t& at, KvEntry& e) {
+    if (at + 8 > data.size()) return false;
+    int kl = getInt32(data, at), vl = getInt32(data, at + 4);
+    if (kl < 0 || vl < -1) return false;
+    size_t need = 8 + (size_t)kl + (vl > 0 ? (size_t)vl : 0);
+    if (at + need > data.size()) return false;
+    e.key = data.substr(at + 8, kl);
+    e.deleted = vl < 0;
+    e.value = e.deleted ? string() : data.substr(at + 8 + kl, vl);
+    at += need;
+    return true;
+}
+
+string kvIndexKey(const KvSegment& seg, int i) {
+    return seg.indexKeys.substr(getInt32(seg.indexSlots, i * 12), getInt32(seg.indexSlots, i * 12 + 4));
+}
+
+int kvIndexOffset(const KvSegment& seg, int i) {
+    return getInt32(seg.indexSlots, i * 12 + 8);
+}
+
+void kvParseIndex(KvSegment& seg, const string& data) {
+    seg.indexKeys.clear(); seg.indexSlots.clear(); seg.indexCount = 0;
+    size_t at = 0;
+    while (at + 4 <= data.size()) {
+        int kl = getInt32(data, at);
+        if (kl < 0 || at + 8 + kl > data.size()) break;
+        putInt32(seg.indexSlots, (int)seg.indexKeys.size()); putInt32(seg.indexSlots, kl); putInt32(seg.indexSlots, getInt32(data, at + 4 + kl));
+        seg.indexKeys += data.substr(at + 4, kl);
+        at += 8 + kl; seg.indexCount++;
+    }
+}
+
+// Header, bloom filter and sparse index of a segment; the records stay on disk
+bool kvLoadSegment(int number, KvSegment& seg) {
+    ifstream fin(kvSegmentFile(number).c_str(), ios::binary);
+    if (!fin.is_open()) return false;
+    string head(KV_HEADER_BYTES, '\0');
+    if (!fin.read(&head[0], KV_HEADER_BYTES) || head.compare(0, 4, "QKV1") != 0) return false;
+    seg.number = number; seg.count = getInt32(head, 4); seg.recordsEnd = getInt32(head, 12);
+    int bloomBytes = getInt32(head, 8);
+    fin.seekg(0, ios::end);
+    streamoff size = fin.tellg();
+    if (bloomBytes <= 0 || size < seg.recordsEnd || seg.recordsEnd < KV_HEADER_BYTES + bloomBytes) return false;
+    seg.bloom.assign(bloomBytes, '\0');
+    fin.seekg(KV_HEADER_BYTES); fin.read(&seg.bloom[0], bloomBytes);
+    string index((size_t)(size - seg.recordsEnd), '\0');
+    fin.seekg(seg.recordsEnd);
+    if (!index.empty()) fin.read(&index[0], index.size());
+    kvParseIndex(seg, index);
+    return true;
+}
+
+// Builds a segment from records added in key order
+struct KvSegmentWriter {
+    string bloom;
+    string records;
+    string index;
+    int count;
+};
+
+void kvWriterStart(KvSegmentWriter& w, int maxKeys) {
+    w.records.clear(); w.index.clear(); w.count = 0;
+    w.bloom.assign((size_t)maxKeys * KV_BLOOM_BITS_PER_KEY / 8 + 1, '\0');
+}
+
+void kvWriterAdd(KvSegmentWriter& w, const KvEntry& e) {
+    if (w.count % KV_INDEX_EVERY == 0) {
+        putInt32(w.index, (int)e.key.size()); w.index += e.key;
+        putInt32(w.index, KV_HEADER_BYTES + (int)w.bloom.size() + (int)w.records.size());
+    }
+    bloomAdd(w.bloom, e.key);
+    kvAppendRecord(w.records, e);
+    w.count++;
+}
+
+bool kvWriterFinish(KvSegmentWriter& w, int number, KvSegment& seg) {
+    int recordsEnd = KV_HEADER_BYTES + (int)w.bloom.size() + (int)w.records.size();
+    string head = "QKV1";
+    putInt32(head, w.count); putInt32(head, (int)w.bloom.size()); putInt32(head, recordsEnd);
+    ofstream fout(kvSegmentFile(number).c_str(), ios::binary | ios::trunc);
+    if (!fout.is_open()) return false;
+    fout.write(head.data(), head.size());
+    fout.write(w.bloom.data(), w.bloom.size());
+    fout.write(w.records.data(), w.records.size());
+    fout.write(w.index.data(), w.index.size());
+    fout.close();
+    if (fout.fail()) return false;
+    seg.number = number; seg.count = w.count; seg.recordsEnd = recordsEnd;
+    seg.bloom.swap(w.bloom);
+    kvParseIndex(seg, w.index);
+    return true;
+}
+
+// Written to a temporary file and renamed, so a crash leaves the old or the new list
+void kvWriteManifest(const KvStore& kv) {
+    string fn = KV_NAME + ".manifest", tmp = fn + ".tmp";
+    ofstream fout(tmp.c_str());
+    if (!fout.is_open()) return;
+    fout << "next " << kv.nextSegment << "\n";
+    for (int s = 0; s < kv.segCount; ++s) fout << "segment " << kv.segs[s].number << "\n";
+    fout.close();
+    remove(fn.c_str());
+    rename(tmp.c_str(), fn.c_str());
+}
+
+// Position of key in the memtable, or where it would go
+int kvMemFind(const KvStore& kv, const string& key, bool& found) {
+    int lo = 0, hi = kv.memCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (kv.mem[mid].key < key) lo = mid + 1; else hi = mid;
+    }
+    found = lo < kv.memCount && kv.mem[lo].key == key;
+    return lo;
+}
+
+void kvMemPut(KvStore& kv, const KvEntry& e) {
+    bool found = false;
+    int i = kvMemFind(kv, e.key, found);
+    if (!found) {
+        if (kv.memCount >= KV_MEMTABLE_ENTRIES) return; // only after a failed flush; the log keeps it
+        for (int k = kv.memCount; k > i; --k) swap(kv.mem[k], kv.mem[k - 1]);
+        kv.memCount++;
+    }
+    kv.mem[i] = e;
+}
+
+// Size-tiered choice of what to merge: the newest segments, extended to an older one only
+// while it is at most twice their combined size, so a large old segment is rewritten only
+// once enough has piled up on top of it. Returns the first segment to merge.
+int kvCompactionStart(const KvStore& kv) {
+    int from = kv.segCount - 1, newer = kv.segs[from].count;
+    while (from > 0 && kv.segs[from - 1].count <= 2 * newer) newer += kv.segs[--from].count;
+    return from;
+}
+
+// Merge segments from..newest into one. Where segments share a key the newest record wins;
+// deletes are dropped when the merge reaches the oldest segment, as nothing older is left
+// for them to hide.
+void kvCompact(KvStore& kv, int from) {
+    if (from < 0 || kv.segCount - from < 2) return;
+    static string data[KV_MAX_SEGMENTS];
+    size_t pos[KV_MAX_SEGMENTS];
+    KvEntry head[KV_MAX_SEGMENTS];
+    bool live[KV_MAX_SEGMENTS];
+    int total = 0;
+    for (int s = from; s < kv.segCount; ++s) {
+        const KvSegment& seg = kv.segs[s];
+        ifstream fin(kvSegmentFile(seg.number).c_str(), ios::binary);
+        data[s].assign(seg.recordsEnd, '\0');
+        if (!fin.is_open() || !fin.read(&data[s][0], seg.recordsEnd)) return; // leave the segments as they are
+        pos[s] = KV_HEADER_BYTES + seg.bloom.size();
+        live[s] = kvParseRecord(data[s], pos[s], head[s]);
+        total += seg.count;
+    }
+    static KvSegmentWriter w;
+    kvWriterStart(w, total);
+    while (true) {
+        int pick = -1;
+        for (int s = from; s < kv.segCount; ++s) if (live[s] && (pick < 0 || head[s].key <= head[pick].key)) pick = s; // ties: newest
+        if (pick < 0) break;
+        KvEntry chosen = head[pick];
+        for (int s = from; s < kv.segCount; ++s) if (live[s] && head[s].key == chosen.key) live[s] = kvParseRecord(data[s], pos[s], head[s]);
+        if (!chosen.deleted || from > 0) kvWriterAdd(w, chosen);
+    }
+    KvSegment merged;
+    if (!kvWriterFinish(w, kv.nextSegment, merged)) return;
+    int oldNumbers[KV_MAX_SEGMENTS], oldCount = 0;
+    for (int s = from; s < kv.segCount; ++s) { oldNumbers[oldCount++] = kv.segs[s].number; data[s].clear(); }
+    kv.segs[from] = merged; kv.segCount = from + 1; kv.nextSegment++;
+    kvWriteManifest(kv);
+    for (int s = 0; s < oldCount; ++s) remove(kvSegmentFile(oldNumbers[s]).c_str());
+    kv.compactions++;
+}
+
+// Write the memtable out as the newest segment and start a fresh log
+void kvFlush(KvStore& kv) {
+    if (kv.memCount == 0) return;
+    if (kv.segCount >= KV_MAX_SEGMENTS) {
+        int from = kvCompactionStart(kv);
+        kvCompact(kv, from < kv.segCount - 2 ? from : kv.segCount - 2); // no room: merge at least two
+    }
+    if (kv.segCount >= KV_MAX_SEGMENTS) return; // could not merge; keep writing to the log
+    static KvSegmentWriter w;
+    kvWriterStart(w, kv.memCount);
+    for (int i = 0; i < kv.memCount; ++i) kvWriterAdd(w, kv.mem[i]);
+    if (!kvWriterFinish(w, kv.nextSegment, kv.segs[kv.segCount])) return;
+    kv.segCount++; kv.nextSegment++;
+    kvWriteManifest(kv);
+    for (int i = 0; i < kv.memCount; ++i) { kv.mem[i].key.clear(); kv.mem[i].value.clear(); }
+    kv.memCount = 0;
+    dropAppends(KV_NAME + ".log"); // every queued record is in the segment
+    ofstream log((KV_NAME + ".log").c_str(), ios::binary | ios::trunc);
+}
+
+KvStore& kvOpen() {
+    KvStore& kv = kvStore();
+    if (kv.opened) return kv;
+    kv.opened = true; kv.memCount = 0; kv.segCount = 0; kv.nextSegment = 1;
+    ifstream man((KV_NAME + ".manifest").c_str());
+    if (!man.is_open()) man.open((KV_NAME + ".manifest.tmp").c_str()); // crashed between remove and rename
+    string line;
+    while (man.is_open() && getline(man, line)) {
+        int n = 0;
+        if (sscanf(line.c_str(), "next %d", &n) == 1) kv.nextSegment = n;
+        else if (sscanf(line.c_str(), "segment %d", &n) == 1 && kv.segCount < KV_MAX_SEGMENTS && kvLoadSegment(n, kv.segs[kv.segCount])) kv.segCount++;
+    }
+    // the log never holds more distinct keys than the memtable, which is flushed when full
+    string data;
+    if (readWholeFile(KV_NAME + ".log", data)) {
+        size_t at = 0; KvEntry e;
+        while (kv.memCount < KV_MEMTABLE_ENTRIES && kvParseRecord(data, at, e)) kvMemPut(kv, e); // a torn tail is dropped
+    }
+    return kv;
+}
+
+bool kvGet(const string& key, string& value) {
+    KvStore& kv = kvOpen();
+    kv.gets++;
+    bool found = false;
+    int i = kvMemFind(kv, key, found);
+    if (found) {
+        if (kv.mem[i].deleted) return false;
+        value = kv.mem[i].value;
+        return true;
+    }
+    for (int s = kv.segCount - 1; s >= 0; --s) {
+        const KvSegment& seg = kv.segs[s];
+        if (seg.indexCount == 0 || !bloomMayContain(seg.bloom, key)) { kv.bloomSkips++; continue; }
+        // the last indexed key <= key starts the only run of records that can hold it
+        int lo = 0, hi = seg.indexCount - 1, run = -1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            if (kvIndexKey(seg, mid) <= key) { run = mid; lo = mid + 1; } else hi = mid - 1;
+        }
+        if (run < 0) continue;
+        int start = kvIndexOffset(seg, run);
+        int end = (run + 1 < seg.indexCount) ? kvIndexOffset(seg, run + 1) : seg.recordsEnd;
+        ifstream fin(kvSegmentFile(seg.number).c_str(), ios::binary);
+        if (!fin.is_open() || end <= start) continue;
+        string block((size_t)(end - start), '\0');
+        fin.seekg(start); fin.read(&block[0], block.size());
+        kv.segmentReads++;
+        size_t at = 0; KvEntry e;
+        while (kvParseRecord(block, at, e) && e.key <= key) {
+            if (e.key != key) continue;
+            if (e.deleted) return false;
+            value.swap(e.value);
+            return true;
+        }
+    }
+    return false;
+}
+
+void kvWrite(const string& key, const string& value, bool deleted) {
+    KvStore& kv = kvOpen();
+    KvEntry e; e.key = key; e.value = value; e.deleted = deleted;
+    string rec; kvAppendRecord(rec, e);
+    queueAppend(KV_NAME + ".log", rec, true);
+    kvMemPut(kv, e);
+    if (kv.memCount >= KV_MEMTABLE_ENTRIES) kvFlush(kv);
+}
+
+void kvPut(const string& key, const string& value) { kvWrite(key, value, false); }
+void kvDelete(const string& key) { kvWrite(key, "", true); }
+
+// Idle-time upkeep: merge segments once enough have piled up
+void kvIdle() {
+    KvStore& kv = kvOpen();
+    if (kv.segCount >= KV_COMPACT_AT) kvCompact(kv, kvCompactionStart(kv));
+}
+
+// Store shape and traffic on one stderr line, for --startup-metric
+void reportPlayerStore() {
+    const KvStore& kv = kvStore();
+    cerr << "[player store] " << kv.segCount << " segments, " << kv.memCount << " keys in memory, " << kv.gets << " gets, "
+        << kv.segmentReads << " segment reads, " << kv.bloomSkips << " bloom skips, " << kv.compactions << " compactions\n";
+}
+
+// ---------- Ratings ----------
+// Every scored answer is an Elo match between the player and the question: a right answer
+// is a win for the player. Expected scores come from an integer table, so ratings are the
+// same on every machine. Question ratings live in RATING_FILE, a fixed-layout binary file:
+//   header:    "QZR2", generation
+//   questions: MAX_SOURCE_IDS x (rating, answers), by global id; rating 0 = not rated yet
+// All integers are 4-byte little-endian. An answer queues its question's record, and the
+// queued records are rewritten in place, in one open, by flushPendingWrites, right after the
+// player ratings they go with.
+// Player ratings are "rating/<generation>/<name>" -> "rating answers" in the player store,
+// and "ratingtop/<generation>" keeps the leaders. A recompute starts a new generation, which
+// leaves every older player rating behind at once.
+
+const string RATING_FILE = "ratings.dat";
+const int RATING_START = 1500;
+const int RATING_HEADER_BYTES = 8;
+const int RATING_QUESTION_BYTES = 8;
+const int RATING_K_NEW = 32;      // players with fewer than RATING_SETTLED_GAMES answers
+const int RATING_K_SETTLED = 16;
+const int RATING_SETTLED_GAMES = 30;
+const int RATING_K_QUESTION = 8;  // questions face many players; move them slowly
+const int RATING_DIFF_CAP = 800;  // expected scores are flat beyond this
+const int RATING_DIFF_STEP = 10;
+const int RATING_TOP_KEPT = 20;   // leaders kept; the top 5 are shown
+// "QZR1" files kept players in the file itself: (name padded to 24 bytes, rating, answers) each
+const int RATING_V1_NAME_BYTES = 24;
+
+struct RatingStore {
+    bool loaded;
+    bool onDisk;  // RATING_FILE holds the full layout, so records can be rewritten in place
+    int generation;
+    int questionRating[MAX_SOURCE_IDS];
+    int questionAnswers[MAX_SOURCE_IDS];
+    int dirtyIds[MAX_SOURCE_IDS]; // question records changed since the last flush
+    int dirtyCount;
+    bool dirty[MAX_SOURCE_IDS];
+};
+
+RatingStore& ratingStore() {
+    static RatingStore s;
+    return s;
+}
+
+struct PlayerRating {
+    int rating;
+    int games;
+};
+
+// Expected score (per mille) of a player facing a question k * RATING_DIFF_STEP points above
+// them: round(1000 / (1 + 10^(k/40))), computed exactly once and kept as integers, so every
+// build rates the same answers the same way
+const int EXPECTED_ABOVE[RATING_DIFF_CAP / RATING_DIFF_STEP + 1] = {
+    500, 486, 471, 457, 443, 429, 415, 401, 387, 373, 360, 347, 334, 321, 309, 297, 285,
+    273, 262, 251, 240, 230, 220, 210, 201, 192, 183, 174, 166, 159, 151, 144, 137, 130,
+    124, 118, 112, 106, 101, 96, 91, 86, 82, 78, 74, 70, 66, 63, 59, 56, 53, 50, 48, 45,
+    43, 40, 38, 36, 34, 32, 31, 29, 27, 26, 25, 23, 22, 21, 20, 18, 17, 17, 16, 15, 14,
+    13, 12, 12, 11, 10, 10
+};
+
+// Expected score (per mille) of a player facing a rating 'diff' points above theirs
+int expectedScore(int diff) {
+    if (diff > RATING_DIFF_CAP) diff = RATING_DIFF_CAP;
+    if (diff < -RATING_DIFF_CAP) diff = -RATING_DIFF_CAP;
+    int k = (diff >= 0 ? diff + RATING_DIFF_STEP / 2 : diff - RATING_DIFF_STEP / 2) / RATING_DIFF_STEP;
+    return k >= 0 ? EXPECTED_ABOVE[k] : 1000 - EXPECTED_ABOVE[-k];
+}
+
+string questionRecord(const RatingStore& s, int id) {
+    string rec; putInt32(rec, s.questionRating[id]); putInt32(rec, s.questionAnswers[id]);
+    return rec;
+}
+
+string ratingHeader(const RatingStore& s) {
+    string h = "QZR2"; putInt32(h, s.generation);
+    return h;
+}
+
+void resetRatings(RatingStore& s) {
+    s.loaded = true; s.onDisk = false; s.dirtyCount = 0;
+    for (int i = 0; i < MAX_SOURCE_IDS; ++i) { s.questionRating[i] = 0; s.questionAnswers[i] = 0; s.dirty[i] = false; }
+}
+
+string ratingKey(const string& name) {
+    return "rating/" + to_string(ratingStore().generation) + "/" + name;
+}
+
+// Leaders of the current generation, best first; returns how many
+int readTopRatings(string names[], PlayerRating ratings[]) {
+    string v; int n = 0;
+    if (!kvGet("ratingtop/" + to_string(ratingStore().generation), v)) return 0;
+    size_t at = 0;
+    while (n < RATING_TOP_KEPT && at < v.size()) {
+        size_t end = v.find('\n', at);
+        if (end == string::npos) end = v.size();
+        string line = v.substr(at, end - at);
+        at = end + 1;
+        int skip = 0;
+        if (sscanf(line.c_str(), "%d %d %n", &ratings[n].rating, &ratings[n].games, &skip) < 2 || skip == 0) continue;
+        names[n++] = line.substr(skip);
+    }
+    return n;
+}
+
+// Keep the leader list current after a player's rating changes. It is maintained one
+// update at a time, so a leader who drops out can be passed over for a player who has not
+// played since; a recompute rebuilds it from scratch.
+void updateTopRatings(const string& name, const PlayerRating& r) {
+    string names[RATING_TOP_KEPT + 1]; PlayerRating ratings[RATING_TOP_KEPT + 1];
+    int n = readTopRatings(names, ratings), k = 0;
+    for (int i = 0; i < n; ++i) if (names[i] != name) { names[k] = names[i]; ratings[k] = ratings[i]; k++; }
+    n = k;
+    int at = n;
+    while (at > 0 && ratings[at - 1].rating < r.rating) at--;
+    if (at >= RATING_TOP_KEPT) return;
+    for (int i = n; i > at; --i) { names[i] = names[i - 1]; ratings[i] = ratings[i - 1]; }
+    names[at] = name; ratings[at] = r;
+    if (n < RATING_TOP_KEPT) n++;
+    string v;
+    for (int i = 0; i < n; ++i) v += to_string(ratings[i].rating) + " " + to_string(ratings[i].games) + " " + names[i] + "\n";
+    kvPut("ratingtop/" + to_string(ratingStore().generation), v);
+}
+
+PlayerRating playerRating(const string& name) {
+    PlayerRating r = { RATING_START, 0 };
+    string v;
+    if (kvGet(ratingKey(name), v)) sscanf(v.c_str(), "%d %d", &r.rating, &r.games);
+    return r;
+}
+
+void setPlayerRating(const string& name, const PlayerRating& r) {
+    kvPut(ratingKey(name), to_string(r.rating) + " " + to_string(r.games));
+    updateTopRatings(name, r);
+}
+
+// Write the whole file (first save, and bulk recomputes)
+void saveAllRatings(RatingStore& s) {
+    ofstream fout(RATING_FILE.c_str(), ios::binary | ios::trunc);
+    if (!fout.is_open()) return;
+    string out = ratingHeader(s);
+    for (int i = 0; i < MAX_SOURCE_IDS; ++i) out += questionRecord(s, i);
+    fout.write(out.data(), out.size());
+    fout.close();
+    s.onDisk = true;
+    for (int i = 0; i < s.dirtyCount; ++i) s.dirty[s.dirtyIds[i]] = false;
+    s.dirtyCount = 0;
+}
+
+RatingStore& loadRatings() {
+    RatingStore& s = ratingStore();
+    if (s.loaded) return s;
+    resetRatings(s);
+    s.generation = 0;
+    ifstream fin(RATING_FILE.c_str(), ios::binary);
+    if (!fin.is_open()) return s;
+    size_t questionsEnd = RATING_HEADER_BYTES + (size_t)MAX_SOURCE_IDS * RATING_QUESTION_BYTES;
+    fin.seekg(0, ios::end);
+    streamoff size = fin.tellg();
+    if (size < (streamoff)questionsEnd) return s; // not ours: start over
+    string data((size_t)size, '\0');
+    fin.seekg(0);
+    fin.read(&data[0], data.size());
+    fin.close();
+    bool v1 = data.compare(0, 4, "QZR1") == 0;
+    if (!v1 && data.compare(0, 4, "QZR2") != 0) return s;
+    for (int i = 0; i < MAX_SOURCE_IDS; ++i) {
+        s.questionRating[i] = getInt32(data, RATING_HEADER_BYTES + (size_t)i * RATING_QUESTION_BYTES);
+        s.questionAnswers[i] = getInt32(data, RATING_HEADER_BYTES + (size_t)i * RATING_QUESTION_BYTES + 4);
+    }
+    if (!v1) { s.generation = getInt32(data, 4); s.onDisk = true; return s; }
+    // move the players of an older file into the player store, then rewrite it without them
+    int count = getInt32(data, 4);
+    for (int p = 0; p < count; ++p) {
+        size_t at = questionsEnd + (size_t)p * (RATING_V1_NAME_BYTES + 8);
+        if (at + RATING_V1_NAME_BYTES + 8 > data.size()) break;
+        string name = data.substr(at, RATING_V1_NAME_BYTES);
+        PlayerRating r = { getInt32(data, at + RATING_V1_NAME_BYTES), getInt32(data, at + RATING_V1_NAME_BYTES + 4) };
+        setPlayerRating(name.substr(0, name.find('\0')), r);
+    }
+    saveAllRatings(s);
+    return s;
+}
+
+// Queue the record of the question one answer changed
+void queueQuestionRating(RatingStore& s, int id) {
+    if (s.dirty[id]) return;
+    s.dirty[id] = true;
+    s.dirtyIds[s.dirtyCount++] = id;
+}
+
+// Rewrite the queued question records in place
+void flushQuestionRatings(RatingStore& s) {
+    if (s.dirtyCount == 0) return;
+    if (!s.onDisk) { saveAllRatings(s); return; }
+    fstream f(RATING_FILE.c_str(), ios::in | ios::out | ios::binary);
+    if (!f.is_open()) { saveAllRatings(s); return; }
+    for (int i = 0; i < s.dirtyCount; ++i) {
+        int id = s.dirtyIds[i];
+        string q = questionRecord(s, id);
+        f.seekp(RATING_HEADER_BYTES + (streamoff)id * RATING_QUESTION_BYTES); f.write(q.data(), q.size());
+        s.dirty[id] = false;
+    }
+    s.dirtyCount = 0;
+    f.close();
+}
+
+// Write every queued append, then the question records: the player ratings reach disk no
+// later than the question ratings of the same answers
+void flushPendingWrites() {
+    flushAppends();
+    RatingStore& s = ratingStore();
+    if (s.loaded) flushQuestionRatings(s);
+}
+
+int playerRatingOf(const string& name) {
+    loadRatings();
+    return playerRating(name).rating;
+}
+
+// Rate one answer: player 'name' against question 'id' (global id; -1 is ignored).
+// Questions start at a rating set by their difficulty. persist = queue the question's record
+// (a recompute writes the file once at the end). Returns the player's rating change.
+int rateAnswer(const string& name, int id, int difficulty, bool correct, bool persist) {
+    RatingStore& s = loadRatings();
+    if (id < 0 || id >= MAX_SOURCE_IDS) return 0;
+    PlayerRating p = playerRating(name);
+    if (s.questionRating[id] == 0) s.questionRating[id] = RATING_START + (difficulty - 2) * 100;
+    int expected = expectedScore(s.questionRating[id] - p.rating);
+    int actual = correct ? 1000 : 0;
+    int k = p.games < RATING_SETTLED_GAMES ? RATING_K_NEW : RATING_K_SETTLED;
+    int delta = k * (actual - expected) / 1000;
+    p.rating += delta; p.games++;
+    setPlayerRating(name, p);
+    s.questionRating[id] -= RATING_K_QUESTION * (actual - expected) / 1000;
+    s.questionAnswers[id]++;
+    if (persist) queueQuestionRating(s, id);
+    return delta;
+}
+
+// Top rated players, shown with the high scores
+void displayTopRatings() {
+    loadRatings();
+    string names[RATING_TOP_KEPT]; PlayerRating ratings[RATING_TOP_KEPT];
+    int n = readTopRatings(names, ratings);
+    if (n == 0) return;
+    cout << "\n================================\n        Top Ratings\n================================\n\n";
+    for (int i = 0; i < n && i < 5; ++i) cout << i + 1 << ". " << names[i] << " - " << ratings[i].rating << " (" << ratings[i].games << " answers)\n";
+}
+
+// ---------- Study mode ----------
+// Questions a player misses in a quiz go into that player's review queue and come back on
+// an SM-2 schedule: a miss is due again the same day, each right answer stretches the
+// interval by the item's ease. The queue is a binary min-heap on due day in a fixed array,
+// with a position index so a question already queued is rescheduled in place. A study
+// session pops only what is due, O(log n) per pop, however many items the player has.
+
+const int STUDY_SESSION_SIZE = 10;
+const int STUDY_EASE_START = 2500; // ease in thousandths (SM-2's 2.5)
+const int STUDY_EASE_MIN = 1300;
+
+struct StudyItem {
+    int id;       // global question id
+    int due;      // day number (days since 1970)
+    int interval; // days
+    int ease;
+    int reps;     // right answers in a row
+    int lapses;
+};
+
+struct StudyQueue {
+    string player;
+    int count;
+    StudyItem heap[MAX_SOURCE_IDS];
+    int pos[MAX_SOURCE_IDS]; // heap slot of each id, -1 when not queued
+};
+
+StudyQueue& studyQueue() {
+    static StudyQueue q;
+    return q;
+}
+
+int studyToday() {
+    return (int)(time(nullptr) / 86400);
+}
+
+// Where study queues were kept before the player store; read once and moved into it
+string studyFile(const string& player) {
+    string f = "study_";
+    for (char ch : player) f += ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')) ? ch : '_';
+    return f + ".txt";
+}
+
+bool studyBefore(const StudyItem& a, const StudyItem& b) {
+    return a.due != b.due ? a.due < b.due : a.id < b.id;
+}
+
+void studySwap(StudyQueue& q, int i, int j) {
+    StudyItem t = q.heap[i]; q.heap[i] = q.heap[j]; q.heap[j] = t;
+    q.pos[q.heap[i].id] = i; q.pos[q.heap[j].id] = j;
+}
+
+void studySiftUp(StudyQueue& q, int i) {
+    while (i > 0 && studyBefore(q.heap[i], q.heap[(i - 1) / 2])) { studySwap(q, i, (i - 1) / 2); i = (i - 1) / 2; }
+}
+
+void studySiftDown(StudyQueue& q, int i) {
+    while (true) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < q.count && studyBefore(q.heap[l], q.heap[m])) m = l;
+        if (r < q.count && studyBefore(q.heap[r], q.heap[m])) m = r;
+        if (m == i) return;
+        studySwap(q, i, m); i = m;
+    }
+}
+
+// Insert, or reschedule the queued item with the same id
+void studyUpsert(StudyQueue& q, const StudyItem& item) {
+    int i = q.pos[item.id];
+    if (i < 0) { i = q.count++; }
+    q.heap[i] = item; q.pos[item.id] = i;
+    studySiftUp(q, i);
+    studySiftDown(q, q.pos[item.id]);
+}
+
+bool studyPop(StudyQueue& q, StudyItem& out) {
+    if (q.count == 0) return false;
+    out = q.heap[0];
+    studySwap(q, 0, --q.count);
+    q.pos[out.id] = -1;
+    studySiftDown(q, 0);
+    return true;
+}
+
+// SM-2 with integer ease. quality: 0-5, below 3 is a miss.
+void studyReview(StudyItem& item, int quality, int today) {
+    item.ease += 100 - (5 - quality) * (80 + (5 - quality) * 20);
+    if (item.ease < STUDY_EASE_MIN) item.ease = STUDY_EASE_MIN;
+    if (quality < 3) { item.reps = 0; item.interval = 0; item.lapses++; }
+    else {
+        item.interval = (item.reps == 0) ? 1 : (item.reps == 1) ? 6 : (item.interval * item.ease + 500) / 1000;
+        item.reps++;
+    }
+    item.due = today + item.interval;
+}
+
+bool addStudyItem(StudyQueue& q, const StudyItem& it) {
+    if (it.id < 0 || it.id >= MAX_SOURCE_IDS || q.pos[it.id] >= 0) return false;
+    q.heap[q.count] = it; q.pos[it.id] = q.count++;
+    return true;
 }
 
-// Load progress: this version accepts both old and new formats.
-// If the file contains the extra line (remaining seconds), it will be read; otherwise default to DEFAULT_TIME_PER_QUESTION.
-bool loadProgress(const string& fn, QuizResult& r) {
-    ifstream fin(fn.c_str());
-    if (!fin.is_open()) return false;
-    if (!getline(fin, r.playerName)) { fin.close(); return false; }
-    string line;
-    if (!getline(fin, line)) { fin.close(); return false; }
-    int sc = 0, cr = 0, wr = 0; long long ts = 0;
-    if (sscanf(line.c_str(), "%d %d %d %lld", &sc, &cr, &wr, &ts) < 4) { fin.close(); return false; }
-    r.score = sc; r.correct = cr; r.wrong = wr; r.timestamp = (time_t)ts;
-    if (!getline(fin, line)) { fin.close(); return false; }
-    // parse answers
-    r.qCount = 0;
-    const char* p = line.c_str();
-    int val;
-    while (sscanf(p, "%d", &val) == 1) {
-        if (r.qCount < MAX_QUIZ_QUESTIONS) r.answers[r.qCount++] = val;
-        // advance p
-        const char* sp = p;
-        while (*sp != '\0' && *sp != ' ') ++sp;
-        if (*sp == '\0') break;
-        p = sp + 1;
+void saveStudyQueue(const StudyQueue& q) {
+    string v;
+    for (int i = 0; i < q.count; ++i) {
+        const StudyItem& it = q.heap[i];
+        putInt32(v, it.id); putInt32(v, it.due); putInt32(v, it.interval); putInt32(v, it.ease); putInt32(v, it.reps); putInt32(v, it.lapses);
     }
-    if (!getline(fin, line)) { fin.close(); return false; }
-    // question indices
-    {
-        const char* q = line.c_str();
-        int qi; int idx = 0;
-        while (sscanf(q, "%d", &qi) == 1) {
-            if (idx < MAX_QUIZ_QUESTIONS) r.questionIndices[idx++] = qi;
-            const char* sp = q;
-            while (*sp != '\0' && *sp != ' ') ++sp;
-            if (*sp == '\0') break;
-            q = sp + 1;
+    kvPut("study/" + q.player, v);
+}
+
+// The player's queue ("study/<name>" in the player store: six integers per item, in heap
+// order, so the heapify pass normally moves nothing) unless it is already in memory.
+StudyQueue& loadStudyQueue(const string& player) {
+    StudyQueue& q = studyQueue();
+    if (q.player == player && !player.empty()) return q;
+    q.player = player; q.count = 0;
+    for (int i = 0; i < MAX_SOURCE_IDS; ++i) q.pos[i] = -1;
+    string v;
+    if (kvGet("study/" + player, v)) {
+        for (size_t at = 0; at + 24 <= v.size() && q.count < MAX_SOURCE_IDS; at += 24) {
+            StudyItem it = { getInt32(v, at), getInt32(v, at + 4), getInt32(v, at + 8), getInt32(v, at + 12), getInt32(v, at + 16), getInt32(v, at + 20) };
+            addStudyItem(q, it);
         }
-        // clamp qCount if needed
-        if (idx < r.qCount) r.qCount = idx;
     }
-    // try read remaining seconds line (optional)
-    if (getline(fin, line)) {
-        try {
-            r.remainingSecondsForCurrent = stoi(line);
-            if (r.remainingSecondsForCurrent < 0) r.remainingSecondsForCurrent = 0;
+    else {
+        ifstream fin(studyFile(player).c_str());
+        string line;
+        while (fin.is_open() && getline(fin, line) && q.count < MAX_SOURCE_IDS) {
+            StudyItem it;
+            if (sscanf(line.c_str(), "%d %d %d %d %d %d", &it.id, &it.due, &it.interval, &it.ease, &it.reps, &it.lapses) == 6) addStudyItem(q, it);
         }
-        catch (...) { r.remainingSecondsForCurrent = DEFAULT_TIME_PER_QUESTION; }
+        if (fin.is_open()) { fin.close(); saveStudyQueue(q); remove(studyFile(player).c_str()); }
     }
-    else {
-        // older save format: assume full time for next question
-        r.remainingSecondsForCurrent = DEFAULT_TIME_PER_QUESTION;
+    for (int i = q.count / 2 - 1; i >= 0; --i) studySiftDown(q, i);
+    return q;
+}
+
+// Queue every question the player got wrong or let time out on in a finished quiz
+void queueMissedQuestions(const QuizResult& r) {
+    StudyQueue& q = loadStudyQueue(r.playerName);
+    int today = studyToday(), added = 0;
+    for (int i = 0; i < r.qCount; ++i) {
+        const QuestionOutcome& o = outcomeAt(r, i);
+        int id = globalQuestionId(r.categoryFile, o.bankIndex);
+        if (id < 0 || (o.kind != OUTCOME_WRONG && o.kind != OUTCOME_TIMEOUT)) continue;
+        StudyItem item = { id, today, 0, STUDY_EASE_START, 0, 0 };
+        if (q.pos[id] >= 0) item = q.heap[q.pos[id]];
+        studyReview(item, 1, today);
+        studyUpsert(q, item);
+        added++;
     }
-    fin.close();
-    return true;
+    if (added > 0) { saveStudyQueue(q); cout << added << " missed question(s) added to your study queue.\n"; }
 }
 
-// get a single non-blocking keypress if available; returns '\0' if none.
-// Uses _kbhit() / _getch() from conio.h
-char getNonBlockingKey() {
-    if (_kbhit()) {
-        int ch = _getch();
-        if (ch == 0 || ch == 224) { // extended key prefix; read and ignore following
-            if (_kbhit()) _getch();
-            return '\0';
+// An untimed answer typed as a line: an option number, the option numbers together
+// (multi-select, e.g. "13"), or a value, in shown terms as the quiz records it. False when
+// input has ended.
+bool readStudyAnswer(const Question& q, int& answer) {
+    while (true) {
+        string s;
+        if (!getline(cin, s)) return false;
+        if (q.type == QUESTION_NUMERIC) {
+            try { answer = stoi(s); return true; }
+            catch (...) {}
         }
-        return (char)ch;
+        else {
+            int mask = 0; bool ok = false; // set by the first option number; blanks alone are no answer
+            for (char ch : s) {
+                if (ch == ' ' || ch == ',') continue;
+                if (ch < '1' || ch >= '1' + q.optionCount) { ok = false; break; }
+                mask |= 1 << (ch - '1');
+                ok = true;
+            }
+            if (ok && q.type == QUESTION_MULTI) { answer = mask; return true; }
+            if (ok && q.type == QUESTION_CHOICE && (mask & (mask - 1)) == 0) {
+                answer = 1; while (!(mask & 1)) { mask >>= 1; answer++; }
+                return true;
+            }
+        }
+        cout << "Please enter " << (q.type == QUESTION_NUMERIC ? "a number" : q.type == QUESTION_MULTI ? "option numbers, e.g. 13" : "an option number") << ": ";
     }
-    return '\0';
 }
 
-// Display remaining seconds on same line (format: Time Remaining: 08s)
-void showRemainingSecondsLine(int rem) {
-    cout << "\rTime Remaining: " << (rem < 10 ? "0" : "") << rem << "s  " << flush;
+// Review the player's due questions, untimed and unscored, and reschedule them
+void startStudy() {
+    cout << "Enter your name: "; string name; getline(cin, name); if (name.empty()) name = "Player";
+    loadAllCategoryBanks();
+    StudyQueue& q = loadStudyQueue(name);
+    int today = studyToday();
+    StudyItem due[STUDY_SESSION_SIZE]; int dueCount = 0;
+    while (dueCount < STUDY_SESSION_SIZE && q.count > 0 && q.heap[0].due <= today) studyPop(q, due[dueCount++]);
+    if (dueCount == 0) {
+        if (q.count == 0) cout << "Your study queue is empty. Questions you miss in a quiz are added to it.\n";
+        else cout << "Nothing due. Next review in " << q.heap[0].due - today << " day(s); " << q.count << " question(s) queued.\n";
+        cout << "Press Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return;
+    }
+    string source = allCategoriesSource();
+    QuizRng rng; rngSeed(rng, makeSessionSeed());
+    int right = 0;
+    for (int i = 0; i < dueCount; ++i) {
+        Question qu; qu.optionCount = -1;
+        materializeSourceQuestion(source, due[i].id, qu);
+        if (qu.optionCount < 0) continue; // bank changed since; drop the item
+        shuffleOptions(qu, rng);
+        QuestionFrame frame; renderQuestionFrame(qu, i + 1, frame);
+        displayQuestionFrame(frame, ALL_OPTIONS_VISIBLE);
+        cout << "\nStudy (" << i + 1 << "/" << dueCount << "), no clock. " << (qu.type == QUESTION_NUMERIC ? "Type your answer" : qu.type == QUESTION_MULTI ? "Type the option numbers" : "Type the option number") << ": ";
+        int answer = 0;
+        if (!readStudyAnswer(qu, answer)) { // input ended: the rest stay due
+            while (i < dueCount) studyUpsert(q, due[i++]);
+            break;
+        }
+        bool correct = answerMatches(qu.type, qu.answerKey, bankAnswerFor(qu, answer));
+        if (correct) { cout << "Correct!\n"; right++; }
+        else cout << "Wrong! Correct answer: " << correctAnswerText(qu) << "\n";
+        displayQuestionNotes(source, due[i].id);
+        studyReview(due[i], correct ? 4 : 1, today);
+        if (correct) cout << "Next review in " << due[i].interval << " day(s).\n";
+        studyUpsert(q, due[i]);
+    }
+    saveStudyQueue(q);
+    flushPendingWrites();
+    cout << "\nStudy session done: " << right << "/" << dueCount << " right. " << q.count << " question(s) in your queue.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
-// startQuiz: main quiz loop with timed questions and lifelines
-void startQuiz(const string& categoryFile, const string& highScoreFile, const string& logFile, const string& saveFile) {
-    Question allQ[MAX_QUESTIONS]; int allCount = 0;
-    if (!loadQuestionsFromFile(categoryFile, allQ, allCount)) {
-        cout << "Could not load questions from " << categoryFile << ". Check file and format.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return;
+// ---------- Saved games ----------
+// One save slot per player, "save/<name>" in the player store, holding the progress text
+// (see formatProgress). An autosave only marks the slot dirty. The progress is formatted and
+// written once the slot has been dirty for intervalMs (checked on every autosave and at the
+// quiz's idle points), or at once at a checkpoint: a place where play stops and the player
+// may walk away, such as the lifeline menu. So a crash loses at most intervalMs of play plus
+// one idle pass, and a quick run of answers costs one write instead of one per question.
+
+const string SAVE_KEY_PREFIX = "save/";
+const string LEGACY_SAVE_FILE = "save_progress.txt"; // the single save of older versions
+const int SAVE_PERSIST_MS = 5000; // default intervalMs
+
+struct SaveSlot {
+    string player;
+    bool dirty;               // progress is newer than the store
+    bool stored;              // the store holds a save for player
+    long long dirtyMs;        // when the slot became dirty
+    int intervalMs;           // longest a change waits; 0 writes every change
+    bool report;              // print this quiz's autosave metrics to stderr at its end
+    int changes;              // autosaves this quiz
+    int writes;
+    long long bytes;
+    long long longestUnsavedMs;
+    long long startMs;
+};
+
+SaveSlot& saveSlot() {
+    static SaveSlot slot;
+    static bool ready = false;
+    if (!ready) { slot.intervalMs = SAVE_PERSIST_MS; ready = true; }
+    return slot;
+}
+
+void persistSaveSlot(SaveSlot& s, const QuizResult& r) {
+    string text = formatProgress(r);
+    kvPut(SAVE_KEY_PREFIX + s.player, text);
+    flushPendingWrites(); // a written save is on disk, with the ratings of the answers it holds
+    long long unsaved = nowMillis() - s.dirtyMs;
+    if (unsaved > s.longestUnsavedMs) s.longestUnsavedMs = unsaved;
+    s.writes++; s.bytes += (long long)text.size();
+    s.dirty = false; s.stored = true;
+}
+
+void autosaveBegin(const string& player) {
+    SaveSlot& s = saveSlot();
+    s.player = player; s.dirty = false; s.stored = false;
+    s.changes = 0; s.writes = 0; s.bytes = 0; s.longestUnsavedMs = 0; s.startMs = nowMillis();
+}
+
+// r has changed; written now at a checkpoint, else once the slot has waited intervalMs
+void autosaveProgress(const QuizResult& r, bool checkpoint) {
+    SaveSlot& s = saveSlot();
+    s.changes++;
+    if (!s.dirty) { s.dirty = true; s.dirtyMs = nowMillis(); }
+    if (checkpoint || nowMillis() - s.dirtyMs >= s.intervalMs) persistSaveSlot(s, r);
+}
+
+// Idle-point check
+void autosaveIdle(const QuizResult& r) {
+    SaveSlot& s = saveSlot();
+    if (s.dirty && nowMillis() - s.dirtyMs >= s.intervalMs) persistSaveSlot(s, r);
+}
+
+// A finished quiz leaves no save behind, including one from an earlier, interrupted game
+void autosaveFinish() {
+    SaveSlot& s = saveSlot();
+    string v;
+    if (s.stored || kvGet(SAVE_KEY_PREFIX + s.player, v)) kvDelete(SAVE_KEY_PREFIX + s.player);
+    s.dirty = false; s.stored = false;
+    flushPendingWrites(); // the quiz's scores, log entry and ratings
+    if (s.report) {
+        const AppendQueue& q = appendQueue();
+        cerr << "[appends] " << q.appends << " appends in " << q.writes << " writes, " << q.bytes << " bytes so far\n";
+        long long ms = nowMillis() - s.startMs;
+        if (ms < 1) ms = 1;
+        cerr << "[autosave] " << s.changes << " changes, " << s.writes << " writes, " << s.bytes << " bytes in " << ms << " ms ("
+            << s.bytes * 1000 / ms << " bytes/s), longest unsaved " << s.longestUnsavedMs << " ms (interval " << s.intervalMs << " ms)\n";
     }
-    int qIndices[MAX_QUESTIONS];
-    for (int i = 0; i < allCount; ++i) qIndices[i] = i;
-    shuffleIntArray(qIndices, allCount);
+}
 
-    cout << "Enter your name: "; string name; getline(cin, name); if (name.empty()) name = "Player";
-    cout << "\nChoose difficulty: 1. Easy 2. Medium 3. Hard\nEnter (1-3): "; int diff = getIntInRange(1, 3);
+// The player's saved progress. A LEGACY_SAVE_FILE is first moved into its player's slot,
+// unless that player already has a newer save.
+bool loadSavedProgress(const string& player, QuizResult& r) {
+    ifstream legacy(LEGACY_SAVE_FILE.c_str());
+    if (legacy.is_open()) {
+        string owner, text, line, v;
+        getline(legacy, owner);
+        text = owner + "\n";
+        while (getline(legacy, line)) text += line + "\n";
+        legacy.close();
+        if (!owner.empty() && !kvGet(SAVE_KEY_PREFIX + owner, v)) kvPut(SAVE_KEY_PREFIX + owner, text);
+        remove(LEGACY_SAVE_FILE.c_str());
+    }
+    string text;
+    if (!kvGet(SAVE_KEY_PREFIX + player, text)) { initOutcomes(r); return false; }
+    istringstream in(text);
+    return readProgress(in, r);
+}
 
-    int pool[MAX_QUESTIONS]; int poolCount = 0;
-    for (int i = 0; i < allCount; ++i) if (allQ[i].difficulty == diff) pool[poolCount++] = i;
-    if (poolCount < 10) { poolCount = 0; for (int i = 0; i < allCount; ++i) pool[poolCount++] = i; }
-    shuffleIntArray(pool, poolCount);
+// playQuiz: main quiz loop with timed questions and lifelines
+// source is a bank file or a "filter:<query>" (see Question sources). A built shared deck (date
+// set) is played exactly as it is, with no mode choice; an empty one lets the player pick a mode
+// and draws from source. The final score goes to board.
+void playQuiz(const string& source, const ScoreBoard& board, const string& logFile, const DailyDeck& shared) {
+    bool daily = shared.date != 0;
+    static int sourceIds[MAX_SOURCE_IDS]; // the Replace lifeline draws from these
+    int sourceCount = sourceQuestionIds(source, sourceIds);
+    if (sourceCount <= 0) {
+        cout << "Could not load questions from " << source << ". Check file and format.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return;
+    }
 
-    int quizCount = poolCount > 10 ? 10 : poolCount;
+    cout << "Enter your name: "; string name; getline(cin, name); if (name.empty()) name = "Player";
+    int mode = MODE_DAILY;
+    if (!daily) {
+        cout << "\nGame mode: 1. Classic (10 questions) 2. Survival (until " << SURVIVAL_LIVES << " misses) 3. Blitz (" << BLITZ_SECONDS << " seconds)\nEnter (1-3): ";
+        const int modeChoices[] = { MODE_SOLO, MODE_SURVIVAL, MODE_BLITZ };
+        mode = modeChoices[getIntInRange(1, 3) - 1];
+    }
+    int diff = 0; // filters choose their own difficulty; streamed modes draw from every difficulty
+    if (!isFilterSource(source) && mode == MODE_SOLO) { cout << "\nChoose difficulty: 1. Easy 2. Medium 3. Hard\nEnter (1-3): "; diff = getIntInRange(1, 3); }
+    bool speedMode = false; // blitz has no per-question clock to be fast against; the daily plays by one rule set
+    if (mode != MODE_BLITZ && mode != MODE_DAILY) {
+        cout << "Enable speed bonus (faster correct answers earn up to +" << SPEED_BONUS_MAX_PERCENT << "%)? (Y/N): ";
+        string sm; getline(cin, sm);
+        speedMode = !sm.empty() && (sm[0] == 'Y' || sm[0] == 'y');
+    }
+
+    // everything random in this quiz comes from one seeded stream, so the log can reproduce it
+    unsigned int seed = daily ? shared.seed : makeSessionSeed();
+    QuizRng rng; rngSeed(rng, seed);
+    // classic quizzes draw their deck up front; streamed modes draw one question at a time
+    int deck[MAX_QUIZ_QUESTIONS];
+    int quizCount = 0;
     Question quizQuestions[MAX_QUIZ_QUESTIONS];
-    for (int i = 0; i < quizCount; ++i) { quizQuestions[i] = allQ[pool[i]]; shuffleOptions(quizQuestions[i]); }
+    static StreamSampler sampler;
+    static PreparedQuestion prepared;
+    prepared.ready = false; prepared.exhausted = false;
+    if (isStreamedMode(mode)) samplerStart(sampler, sourceCount, seed);
+    else if (daily) {
+        quizCount = shared.count;
+        for (int i = 0; i < quizCount; ++i) quizQuestions[i] = shared.questions[i];
+    }
+    else quizCount = takeQuizDeck(source, diff, seed, rng, deck);
+    if (!daily) for (int i = 0; i < quizCount; ++i) { materializeSourceQuestion(source, deck[i], quizQuestions[i]); shuffleOptions(quizQuestions[i], rng); }
 
-    // lifeline availability
-    bool lif_5050 = true, lif_skip = true, lif_replace = true, lif_extra = true;
+    // LIFELINE_* bits still available; blitz has none, a paused menu would stop its one clock,
+    // and the daily has no Replace, which would step off the shared deck
+    int lifelines = (mode == MODE_BLITZ) ? 0 : ALL_LIFELINES;
+    if (daily) lifelines &= ~LIFELINE_REPLACE;
 
-    int score = 0, correctCount = 0, wrongCount = 0, streak = 0;
-    QuizResult result; result.playerName = name; result.score = 0; result.correct = 0; result.wrong = 0; result.timestamp = time(nullptr); result.qCount = 0; result.remainingSecondsForCurrent = 0;
+    ScoreState st; st.score = 0; st.correct = 0; st.wrong = 0; st.streak = 0;
+    QuizResult result; result.playerName = name; result.score = 0; result.correct = 0; result.wrong = 0; result.timestamp = time(nullptr); initOutcomes(result); result.remainingSecondsForCurrent = 0; result.speedMode = speedMode;
+    autosaveBegin(name);
+    result.seed = seed; result.categoryFile = source; result.difficulty = diff; result.mode = mode;
 
     cout << "\nQuiz starting! Press Enter to start..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); // wait for enter
 
-    for (int qi = 0; qi < quizCount; ++qi) {
-        Question& q = quizQuestions[qi];
-        result.questionIndices[result.qCount] = qi;
-        result.answers[result.qCount] = 0;
-        int visibleOptions[MAX_OPTIONS] = { 0,1,2,3 }; int visibleCount = 4;
-        bool questionCompleted = false;
-
-        // Determine starting remaining seconds for this question:
-        int remainingSeconds = DEFAULT_TIME_PER_QUESTION;
+    int ratingChange = 0;
+    long long blitzEndMs = nowMillis() + BLITZ_SECONDS * 1000LL; // the one deadline for a blitz
+    Question streamQuestion;
+    for (int qi = 0; ; ++qi) {
+        QuestionFrame frame;
+        if (isStreamedMode(mode)) {
+            if (mode == MODE_SURVIVAL && st.wrong >= SURVIVAL_LIVES) break;
+            if (mode == MODE_BLITZ && nowMillis() >= blitzEndMs) break;
+            // blitz has normally prepared this one while the previous question was up
+            if (!prepared.ready) prepareStreamQuestion(source, sourceIds, sampler, rng, qi + 1, prepared);
+            if (!prepared.ready) break;
+            swap(streamQuestion, prepared.q); swap(frame, prepared.frame); prepared.ready = false;
+            if (mode == MODE_SURVIVAL) cout << "\n[Survival] Lives left: " << SURVIVAL_LIVES - st.wrong << " | Questions survived: " << qi;
+            else cout << "\n[Blitz] Answered: " << qi << " | Score: " << st.score;
+        }
+        else if (qi >= quizCount) break;
+        Question& q = isStreamedMode(mode) ? streamQuestion : quizQuestions[qi];
+        int answer = 0, outcomeKind = 0, answerMs = 0;
+        int selectedMask = 0; string typed; // multi-select / numeric entry so far
+        int visibleMask = ALL_OPTIONS_VISIBLE;
+        bool questionCompleted = false, clockOut = false;
+        if (daily) frame = shared.frames[qi];
+        else if (!isStreamedMode(mode)) renderQuestionFrame(q, qi + 1, frame);
+
+        // Determine starting remaining time (milliseconds) for this question:
+        int remainingMs = DEFAULT_TIME_PER_QUESTION * 1000;
         // If saved progress indicates time for current (only relevant if we used resume to pre-populate result earlier),
         // use it and then reset it so it's not reused for subsequent questions.
         if (result.remainingSecondsForCurrent > 0) {
-            remainingSeconds = result.remainingSecondsForCurrent;
+            remainingMs = result.remainingSecondsForCurrent * 1000;
             result.remainingSecondsForCurrent = 0;
         }
 
-        // We'll use time() to control the countdown.
-        // endTime holds the target epoch when the question will expire.
-        time_t endTime = time(NULL) + remainingSeconds;
+        // We'll use nowMillis() to control the countdown.
+        // endMs holds the target clock value (ms) when the question will expire.
+        long long endMs = (mode == MODE_BLITZ) ? blitzEndMs : nowMillis() + remainingMs;
 
         while (!questionCompleted) {
-            cout << "\n================================\n";
-            cout << "Question " << (qi + 1) << " (Difficulty " << q.difficulty << ")\n";
-            displayQuestionWithVisibleOptions(q, visibleOptions, visibleCount);
-            cout << "\nLifelines: ";
-            if (lif_5050) cout << "[1]50/50 ";
-            if (lif_skip) cout << "[2]Skip ";
-            if (lif_replace) cout << "[3]Replace ";
-            if (lif_extra) cout << "[4]ExtraTime ";
-            cout << "\nPress 1-4 to answer immediately, or press L to use a lifeline." << endl;
+            displayQuestionFrame(frame, visibleMask);
+            if (mode == MODE_BLITZ) cout << "\n" << answerPrompt(q) << "." << endl;
+            else {
+                cout << lifelineBar(lifelines);
+                cout << "\n" << answerPrompt(q) << ", or press L to use a lifeline." << endl;
+            }
 
             // Show initial remaining seconds line
-            int rem = (int)(endTime - time(NULL));
-            if (rem < 0) rem = 0;
-            showRemainingSecondsLine(rem);
+            showRemainingSecondsLine(msToDisplaySeconds((int)(endMs - nowMillis())), answerEntryText(q, selectedMask, typed));
 
-            // Polling loop using time() and _kbhit()
+            // Polling loop using nowMillis() and _kbhit()
             bool innerLoop = true;
             while (innerLoop && !questionCompleted) {
                 // check for keypress
                 char k = getNonBlockingKey();
                 if (k != '\0') {
-                    if (k >= '1' && k <= '4') {
+                    bool submit = false;
+                    bool enter = (k == '\r' || k == '\n');
+                    bool optionKey = (k >= '1' && k < '1' + q.optionCount);
+                    if (q.type == QUESTION_CHOICE && optionKey) { answer = k - '0'; submit = true; }
+                    else if (q.type == QUESTION_MULTI && optionKey) selectedMask ^= 1 << (k - '1');
+                    else if (q.type == QUESTION_MULTI && enter && selectedMask != 0) { answer = selectedMask; submit = true; }
+                    else if (q.type == QUESTION_NUMERIC && ((k >= '0' && k <= '9') || (k == '-' && typed.empty())) && typed.size() < 9) typed += k;
+                    else if (q.type == QUESTION_NUMERIC && (k == '\b' || k == 127) && !typed.empty()) typed.pop_back();
+                    else if (q.type == QUESTION_NUMERIC && enter && !typed.empty() && typed != "-") { answer = atoi(typed.c_str()); submit = true; }
+                    if (submit) {
                         // immediate answer
-                        int ans = k - '0';
-                        result.answers[result.qCount] = ans;
-                        // save remaining seconds
-                        remainingSeconds = (int)(endTime - time(NULL));
-                        if (remainingSeconds < 0) remainingSeconds = 0;
-                        result.remainingSecondsForCurrent = remainingSeconds;
+                        outcomeKind = answerMatches(q.type, q.answerKey, bankAnswerFor(q, answer)) ? OUTCOME_CORRECT : OUTCOME_WRONG;
+                        // capture keypress-to-deadline time left in ms
+                        remainingMs = (int)(endMs - nowMillis());
+                        if (remainingMs < 0) remainingMs = 0;
+                        answerMs = remainingMs;
                         cout << "\n"; // move to next line
                         questionCompleted = true;
                         innerLoop = false;
                         break;
                     }
-                    else if (k == 'L' || k == 'l') {
+                    else if ((k == 'L' || k == 'l') && mode != MODE_BLITZ) {
                         // pause timer and show lifeline menu
-                        remainingSeconds = (int)(endTime - time(NULL));
-                        if (remainingSeconds < 0) remainingSeconds = 0;
-                        result.remainingSecondsForCurrent = remainingSeconds;
+                        remainingMs = (int)(endMs - nowMillis());
+                        if (remainingMs < 0) remainingMs = 0;
+                        result.remainingSecondsForCurrent = msToDisplaySeconds(remainingMs);
+                        result.timestamp = time(nullptr);
+                        autosaveProgress(result, true); // checkpoint: the player may leave from here
                         cout << "\n"; // new line to interact
                         cout << "\n--- Lifelines menu (timer paused) ---\n";
-                        cout << "1 = 50/50   (remove two wrong options)\n";
+                        cout << "1 = 50/50   (remove all wrong options but one)\n";
                         cout << "2 = Skip    (skip question, no time penalty, moves on)\n";
                         cout << "3 = Replace (replace with another question; remaining time preserved)\n";
                         cout << "4 = ExtraTime (+10s to remaining time) [usable once per quiz]\n";
@@ -398,73 +3066,82 @@ void startQuiz(const string& categoryFile, const string& highScoreFile, const st
                             cout << "Lifeline cancelled. Resuming timer.\n";
                         }
                         else if (li == 1) {
-                            if (!lif_5050) { cout << "50/50 already used.\n"; }
+                            if (!(lifelines & LIFELINE_5050)) { cout << "50/50 already used.\n"; }
+                            else if (!apply5050(q, visibleMask, rng)) { cout << "50/50 cannot remove anything from this question.\n"; }
                             else {
-                                lif_5050 = false;
-                                apply5050(q, visibleOptions, visibleCount);
-                                cout << "50/50 used. Two wrong options removed. Resuming timer.\n";
+                                lifelines &= ~LIFELINE_5050;
+                                cout << "50/50 used. All wrong options but one removed. Resuming timer.\n";
                             }
                         }
                         else if (li == 2) {
-                            if (!lif_skip) { cout << "Skip already used.\n"; }
+                            if (!(lifelines & LIFELINE_SKIP)) { cout << "Skip already used.\n"; }
                             else {
-                                lif_skip = false;
+                                lifelines &= ~LIFELINE_SKIP;
                                 cout << "Question skipped. Moving to next question.\n";
-                                result.answers[result.qCount] = 0; // mark as skipped/unanswered
-                                result.remainingSecondsForCurrent = 0;
+                                outcomeKind = OUTCOME_SKIPPED;
                                 questionCompleted = true;
                                 innerLoop = false;
                                 break;
                             }
                         }
                         else if (li == 3) {
-                            if (!lif_replace) { cout << "Replace already used.\n"; }
+                            if (!(lifelines & LIFELINE_REPLACE)) { cout << "Replace already used.\n"; }
                             else {
-                                lif_replace = false;
+                                lifelines &= ~LIFELINE_REPLACE;
                                 bool replaced = false;
-                                for (int attempt = 0; attempt < allCount; ++attempt) {
-                                    int r = rand() % allCount;
-                                    if (allQ[r].text != q.text) {
-                                        Question cand = allQ[r];
-                                        shuffleOptions(cand);
-                                        q = cand;
-                                        // reset visible options to all visible
-                                        visibleOptions[0] = 0; visibleOptions[1] = 1; visibleOptions[2] = 2; visibleOptions[3] = 3;
-                                        visibleCount = 4;
-                                        replaced = true;
-                                        break;
+                                int r = -1;
+                                if (isStreamedMode(mode)) {
+                                    // the sampler's next draw: not served yet, and never served again this run
+                                    int pos = samplerNext(sampler);
+                                    if (pos >= 0) r = sourceIds[pos];
+                                }
+                                else {
+                                    for (int attempt = 0; attempt < sourceCount && r < 0; ++attempt) {
+                                        int c = sourceIds[rngBelow(rng, sourceCount)];
+                                        if (c != q.bankIndex) r = c;
                                     }
                                 }
+                                if (r >= 0) {
+                                    Question cand; materializeSourceQuestion(source, r, cand);
+                                    shuffleOptions(cand, rng);
+                                    q = cand;
+                                    renderQuestionFrame(q, qi + 1, frame);
+                                    // reset visible options to all visible, and any entry
+                                    visibleMask = ALL_OPTIONS_VISIBLE;
+                                    selectedMask = 0; typed.clear();
+                                    replaced = true;
+                                }
                                 if (!replaced) cout << "No replacement found.\n"; else cout << "Question replaced. Remaining time preserved.\n";
-                                // remainingSeconds is preserved
-                                endTime = time(NULL) + remainingSeconds;
+                                // remainingMs is preserved
+                                endMs = nowMillis() + remainingMs;
                             }
                         }
                         else if (li == 4) {
-                            if (!lif_extra) { cout << "Extra Time already used.\n"; }
+                            if (!(lifelines & LIFELINE_EXTRA)) { cout << "Extra Time already used.\n"; }
                             else {
-                                if (remainingSeconds <= 0) {
+                                if (remainingMs <= 0) {
                                     cout << "Cannot use Extra Time: question already expired.\n";
                                 }
                                 else {
-                                    lif_extra = false;
-                                    remainingSeconds += EXTRA_TIME_AMOUNT;
-                                    cout << "Extra Time applied. +" << EXTRA_TIME_AMOUNT << "s added. New remaining: " << remainingSeconds << "s. Resuming timer.\n";
-                                    endTime = time(NULL) + remainingSeconds;
+                                    lifelines &= ~LIFELINE_EXTRA;
+                                    remainingMs += EXTRA_TIME_AMOUNT * 1000;
+                                    cout << "Extra Time applied. +" << EXTRA_TIME_AMOUNT << "s added. New remaining: " << msToDisplaySeconds(remainingMs) << "s. Resuming timer.\n";
+                                    endMs = nowMillis() + remainingMs;
                                 }
                             }
                         }
-                        // after lifeline menu, resume timer; break inner loop to re-display question and time properly
+                        // after lifeline menu, resume timer from the paused remaining time;
+                        // break inner loop to re-display question and time properly
+                        endMs = nowMillis() + remainingMs;
                         innerLoop = false;
                         break;
                     }
                     else if (k == 'S' || k == 's') {
                         // quick skip mapped to S (optional)
-                        if (lif_skip) {
-                            lif_skip = false;
+                        if (lifelines & LIFELINE_SKIP) {
+                            lifelines &= ~LIFELINE_SKIP;
                             cout << "\nQuick skip used. Moving to next question.\n";
-                            result.answers[result.qCount] = 0;
-                            result.remainingSecondsForCurrent = 0;
+                            outcomeKind = OUTCOME_SKIPPED;
                             questionCompleted = true;
                             innerLoop = false;
                             break;
@@ -477,140 +3154,740 @@ void startQuiz(const string& categoryFile, const string& highScoreFile, const st
                 }
 
                 // check timeout
-                time_t nowt = time(NULL);
-                int nowRem = (int)(endTime - nowt);
-                if (nowRem < 0) nowRem = 0;
-                showRemainingSecondsLine(nowRem);
-                if (nowt >= endTime) {
-                    // time's up
-                    cout << "\nTime's up! Correct answer: " << q.options[q.correctIndex] << "\n";
-                    result.answers[result.qCount] = 0; // unanswered
-                    result.remainingSecondsForCurrent = 0;
-                    wrongCount++; streak = 0;
-                    if (q.difficulty == 1) score -= 2; else if (q.difficulty == 2) score -= 3; else score -= 5;
+                long long nowt = nowMillis();
+                showRemainingSecondsLine(msToDisplaySeconds((int)(endMs - nowt)), answerEntryText(q, selectedMask, typed));
+                if (nowt >= endMs) {
+                    // time's up; in blitz the whole quiz is over and this question is not scored
+                    cout << "\nTime's up! ";
+                    outcomeKind = OUTCOME_TIMEOUT;
+                    clockOut = (mode == MODE_BLITZ);
                     questionCompleted = true;
                     innerLoop = false;
                     break;
                 }
 
-                // small pause to avoid busy spinning; do a simple blocking sleep via time-based busy-wait for ~100ms
-                // (we avoid <thread> and <chrono>; we'll approximate with a short loop that checks time)
-                // compute a target time 100ms later
-                time_t tstart = time(NULL);
-                // Since time(NULL) has 1s granularity, instead do a crude busy wait with a quick for-loop to yield CPU briefly.
-                for (int spin = 0; spin < 20000; ++spin) {
-                    // small no-op to yield CPU; this keeps the loop lightweight without threads/chrono.
-                    // On modern machines this is enough to avoid burning CPU too hard while still responsive.
-                    // If you want a better sleep, platform-specific Sleep(ms) from windows.h can be used.
-                    volatile int x = spin * spin;
-                    (void)x;
-                    // check if a key became available to break sooner
-                    if (_kbhit()) break;
-                }
+                // blitz spends its first idle pass building the next question, so moving on costs nothing
+                if (mode == MODE_BLITZ && !prepared.ready && !prepared.exhausted) prepareStreamQuestion(source, sourceIds, sampler, rng, qi + 2, prepared);
+                else { autosaveIdle(result); idlePause(); }
             } // end inner polling loop
 
-            // auto-save progress whenever lifeline used or we break to outer loop
-            result.score = score; result.correct = correctCount; result.wrong = wrongCount; result.timestamp = time(nullptr);
+            // auto-save progress when we break to the outer loop with the question still open (lifeline used),
+            // so a resume gets the remaining time after the lifeline; completed questions are saved once below
             if (!questionCompleted) {
-                // compute remainingSeconds and save
-                remainingSeconds = (int)(endTime - time(NULL));
-                if (remainingSeconds < 0) remainingSeconds = 0;
-                result.remainingSecondsForCurrent = remainingSeconds;
-            }
-            else {
-                result.remainingSecondsForCurrent = 0;
+                result.timestamp = time(nullptr);
+                result.remainingSecondsForCurrent = msToDisplaySeconds(remainingMs);
+                autosaveProgress(result, false);
             }
-            saveProgress(saveFile, result);
 
             // loop repeats if question is not completed (e.g., lifeline used and we want to redraw)
         } // while !questionCompleted
+        if (clockOut) { cout << "\n"; break; }
 
-        // evaluate (if not already done due to timeout/skip)
-        int userAns = result.answers[result.qCount];
-        if (userAns == 0) {
-            // either skipped, unanswered (timed out), or explicitly left blank
-            cout << "Question not answered.\n";
-            // wrongCount already adjusted for timeouts; if skip or initial unanswered we already incremented? To be safe:
-            // (In this implementation we incremented wrongCount on timeout only; for skip we do not increment wrongCount here)
-            if (q.difficulty == 1 && userAns == 0) {
-                // If it was timed out, we already deducted; if skipped we apply negative marking now
-                // To avoid double-penalty, we won't deduct again if time already subtracted.
-                // Simple approach: apply deduction if time wasn't the cause (we can't easily detect here), but keep consistent:
-                // We'll apply deduction for unanswered/skipped except when it was timed out (we already applied).
-                // For simplicity, apply deduction always here (this matches earlier simplified version).
-            }
-            // For simplicity and to match earlier behavior, apply deduction here as well (may double-deduct timeouts).
-            // To avoid double-deduction for timeouts, a more elaborate flag would be needed. We'll apply single deduction here:
-            // (Assume previous timeout deduction already applied; avoid double-deduction by not applying here.)
-            // So do nothing additional.
+        // evaluate: build this question's single outcome record and apply it
+        QuestionOutcome o;
+        o.questionIndex = qi; o.bankIndex = q.bankIndex; o.answer = answer; o.kind = outcomeKind;
+        o.bankAnswer = (outcomeKind == OUTCOME_CORRECT || outcomeKind == OUTCOME_WRONG) ? bankAnswerFor(q, answer) : 0;
+        o.difficulty = q.difficulty; o.remainingMs = answerMs;
+        applyOutcome(st, o, result.speedMode);
+        if (o.kind != OUTCOME_SKIPPED) ratingChange += rateAnswer(result.playerName, globalQuestionId(source, o.bankIndex), o.difficulty, o.kind == OUTCOME_CORRECT, true);
+
+        if (o.kind == OUTCOME_CORRECT) {
+            cout << "Correct!\n";
+            if (o.streakBonus == 5) cout << "Streak! +5 bonus\n";
+            else if (o.streakBonus == 15) cout << "Big Streak! +15 bonus\n";
+            cout << "Earned " << basePointsFor(o.difficulty) << " points.\n";
+            if (result.speedMode) cout << "Speed bonus: +" << o.speedBonus << " (" << o.remainingMs << " ms left)\n";
+        }
+        else if (o.kind == OUTCOME_WRONG) {
+            cout << "Wrong! Correct answer: " << correctAnswerText(q) << "\n";
+        }
+        else if (o.kind == OUTCOME_TIMEOUT) {
+            cout << "Correct answer: " << correctAnswerText(q) << " (-" << penaltyFor(o.difficulty) << " points)\n";
         }
         else {
-            if (userAns - 1 == q.correctIndex) {
-                cout << "Correct!\n";
-                int add = (q.difficulty == 1 ? 10 : (q.difficulty == 2 ? 15 : 20));
-                score += add; correctCount++; streak++;
-                if (streak == 3) { cout << "Streak! +5 bonus\n"; score += 5; }
-                else if (streak == 5) { cout << "Big Streak! +15 bonus\n"; score += 15; }
-                cout << "Earned " << add << " points.\n";
-            }
-            else {
-                cout << "Wrong! Correct answer: " << q.options[q.correctIndex] << "\n";
-                wrongCount++; streak = 0;
-                if (q.difficulty == 1) score -= 2; else if (q.difficulty == 2) score -= 3; else score -= 5;
-            }
+            cout << "Question not answered.\n";
         }
+        displayQuestionNotes(source, q.bankIndex);
 
-        result.score = score; result.correct = correctCount; result.wrong = wrongCount; result.timestamp = time(nullptr);
-        result.qCount++;
-        saveProgress(saveFile, result);
+        bool recorded = appendOutcome(result, o);
+        result.score = st.score; result.correct = st.correct; result.wrong = st.wrong; result.timestamp = time(nullptr);
+        result.remainingSecondsForCurrent = 0;
+        autosaveProgress(result, false);
+        if (!recorded) { cout << "Outcome storage is full; ending the quiz here.\n"; break; }
     } // for each question
 
+    int score = st.score;
     if (score < 0) score = 0;
-    cout << "\n================================\nQuiz Completed!\nYour Final Score: " << score << "\nCorrect: " << correctCount << " Wrong: " << wrongCount << "\n";
+    string heading = "Quiz Completed!";
+    if (mode == MODE_SURVIVAL) heading = "Survival over! Questions answered: " + to_string(result.qCount);
+    else if (mode == MODE_BLITZ) heading = "Blitz over! Questions answered: " + to_string(result.qCount);
+    cout << "\n================================\n" << heading
+        << "\nYour Final Score: " << score << "\nCorrect: " << st.correct << " Wrong: " << st.wrong << "\n";
+    cout << "Rating: " << playerRatingOf(result.playerName) << " (" << (ratingChange >= 0 ? "+" : "") << ratingChange << ")\n";
     ScoreEntry e; e.name = result.playerName; e.score = score; e.datetime = nowString();
-    writeHighScore(highScoreFile, e);
+    recordScore(board, e);
     logSession(logFile, result);
-    remove(saveFile.c_str());
+    queueMissedQuestions(result);
+    releaseOutcomes(result);
+    autosaveFinish();
+    cout << "Press Enter to return to menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+// A quiz of the player's chosen mode, scored on the all-time board in highScoreFile
+void startQuiz(const string& source, const string& highScoreFile, const string& logFile) {
+    static DailyDeck noDeck; // date 0: not a daily
+    ScoreBoard board; board.file = highScoreFile; board.date = 0;
+    playQuiz(source, board, logFile, noDeck);
+}
+
+// ---------- Head-to-head rooms ----------
+
+// One accepted keypress in a room, waiting to be scored with the rest of its question's batch
+struct RoomAnswer {
+    int seat;
+    int option;      // 1-4 as shown
+    int remainingMs;
+};
+
+// Per-question aggregate over the whole room
+struct QuestionStats {
+    int optionCounts[MAX_OPTIONS];
+    int answered;
+    int correct;
+    int timeouts;
+    long long totalRemainingMs; // over answered players, for the average answer speed
+};
+
+// Re-sort the room leaderboard (order[] holds player ids, best first).
+// Insertion sort: called once per question batch, and the order barely changes between batches.
+void sortRoomLeaderboard(int order[], int n, const ScoreState st[]) {
+    for (int i = 1; i < n; ++i) {
+        int id = order[i]; int j = i - 1;
+        while (j >= 0 && st[order[j]].score < st[id].score) { order[j + 1] = order[j]; --j; }
+        order[j + 1] = id;
+    }
+}
+
+// Score one question's batch of answers: every seat gets exactly one outcome (seats missing
+// from the batch timed out), and the per-question aggregate is filled in the same pass.
+void scoreAnswerBatch(const Question& q, int qi, const RoomAnswer batch[], int batchCount, int playerCount,
+    QuizResult results[], ScoreState st[], QuestionStats& stats) {
+    int optionOf[MAX_ROOM_PLAYERS] = { 0, 0, 0, 0 };
+    int msOf[MAX_ROOM_PLAYERS] = { 0, 0, 0, 0 };
+    for (int i = 0; i < MAX_OPTIONS; ++i) stats.optionCounts[i] = 0;
+    stats.answered = 0; stats.correct = 0; stats.timeouts = 0; stats.totalRemainingMs = 0;
+    for (int i = 0; i < batchCount; ++i) { optionOf[batch[i].seat] = batch[i].option; msOf[batch[i].seat] = batch[i].remainingMs; }
+    for (int p = 0; p < playerCount; ++p) {
+        QuestionOutcome o;
+        o.questionIndex = qi; o.bankIndex = q.bankIndex; o.difficulty = q.difficulty;
+        o.answer = optionOf[p]; o.remainingMs = msOf[p];
+        if (o.answer == 0) {
+            o.bankAnswer = 0; o.kind = OUTCOME_TIMEOUT;
+            stats.timeouts++;
+        }
+        else {
+            o.bankAnswer = q.optionOrder[o.answer - 1] + 1;
+            o.kind = (o.answer - 1 == q.correctIndex) ? OUTCOME_CORRECT : OUTCOME_WRONG;
+            stats.optionCounts[o.answer - 1]++; stats.answered++; stats.totalRemainingMs += o.remainingMs;
+            if (o.kind == OUTCOME_CORRECT) stats.correct++;
+        }
+        applyOutcome(st[p], o, false);
+        appendOutcome(results[p], o);
+        rateAnswer(results[p].playerName, globalQuestionId(results[p].categoryFile, o.bankIndex), o.difficulty, o.kind == OUTCOME_CORRECT, true);
+    }
+}
+
+void displayRoomLeaderboard(const int order[], int n, const QuizResult results[], const ScoreState st[]) {
+    int widths[MAX_ROOM_PLAYERS]; int maxWidth = 0;
+    for (int p = 0; p < n; ++p) { widths[p] = displayWidth(results[p].playerName); if (widths[p] > maxWidth) maxWidth = widths[p]; }
+    cout << "--- Room leaderboard ---\n";
+    for (int i = 0; i < n; ++i) cout << i + 1 << ". " << padToWidth(results[order[i]].playerName, widths[order[i]], maxWidth) << "  " << st[order[i]].score << " points\n";
+}
+
+// Map a key to a room seat and option; returns false if the key belongs to nobody.
+bool roomKeyToSeat(char k, int playerCount, int& seat, int& option) {
+    if (k >= 'A' && k <= 'Z') k = (char)(k - 'A' + 'a');
+    for (int p = 0; p < playerCount; ++p) {
+        size_t at = ROOM_KEYS[p].find(k);
+        if (at != string::npos) { seat = p; option = (int)at + 1; return true; }
+    }
+    return false;
+}
+
+// startRoom: 2-4 players on one keyboard answer the same questions against one shared
+// deadline per question. Answers are only validated while the clock runs; the whole
+// question is scored as one batch when everyone has answered or time is up.
+void startRoom(const string& categoryFile, const string& highScoreFile, const string& logFile) {
+    if (findOrLoadBank(categoryFile) < 0) {
+        cout << "Could not load questions from " << categoryFile << ". Check file and format.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return;
+    }
+    cout << "Number of players (2-" << MAX_ROOM_PLAYERS << "): "; int playerCount = getIntInRange(2, MAX_ROOM_PLAYERS);
+    QuizResult results[MAX_ROOM_PLAYERS];
+    ScoreState st[MAX_ROOM_PLAYERS];
+    int order[MAX_ROOM_PLAYERS];
+    for (int p = 0; p < playerCount; ++p) {
+        cout << "Player " << p + 1 << " name (answers with " << ROOM_KEYS[p] << "): ";
+        string name; getline(cin, name); if (name.empty()) name = "Player " + to_string(p + 1);
+        results[p].playerName = name; initOutcomes(results[p]); results[p].remainingSecondsForCurrent = 0; results[p].speedMode = false; results[p].mode = MODE_ROOM;
+        st[p].score = 0; st[p].correct = 0; st[p].wrong = 0; st[p].streak = 0;
+        order[p] = p;
+    }
+    cout << "\nChoose difficulty: 1. Easy 2. Medium 3. Hard\nEnter (1-3): "; int diff = getIntInRange(1, 3);
+
+    // one deck for the whole room
+    unsigned int seed = makeSessionSeed();
+    QuizRng rng; rngSeed(rng, seed);
+    int deck[MAX_QUIZ_QUESTIONS];
+    int quizCount = buildSourceDeck(categoryFile, diff, MODE_ROOM, rng, deck);
+    Question quizQuestions[MAX_QUIZ_QUESTIONS];
+    for (int i = 0; i < quizCount; ++i) { materializeSourceQuestion(categoryFile, deck[i], quizQuestions[i]); shuffleOptions(quizQuestions[i], rng); }
+    for (int p = 0; p < playerCount; ++p) { results[p].seed = seed; results[p].categoryFile = categoryFile; results[p].difficulty = diff; }
+
+    cout << "\nRoom ready! The first key each player presses is final. Press Enter to start..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    for (int qi = 0; qi < quizCount; ++qi) {
+        const Question& q = quizQuestions[qi];
+        // rendered once and written once for the whole room
+        QuestionFrame frame; renderQuestionFrame(q, qi + 1, frame);
+        displayQuestionFrame(frame, ALL_OPTIONS_VISIBLE);
+        cout << "\n";
+        for (int p = 0; p < playerCount; ++p) cout << results[p].playerName << ": " << ROOM_KEYS[p] << "   ";
+        cout << endl;
+
+        // ingest: validate keys into the batch only; nothing is scored until the window closes
+        int answeredSeats = 0; // bit p = seat p has locked in
+        RoomAnswer batch[MAX_ROOM_PLAYERS] = {}; int batchCount = 0;
+        long long endMs = nowMillis() + DEFAULT_TIME_PER_QUESTION * 1000;
+        showRemainingSecondsLine(DEFAULT_TIME_PER_QUESTION, "");
+        while (batchCount < playerCount) {
+            char k = getNonBlockingKey();
+            int seat = 0, option = 0;
+            if (k != '\0' && roomKeyToSeat(k, playerCount, seat, option) && option <= q.optionCount && !(answeredSeats & (1 << seat))) {
+                int remainingMs = (int)(endMs - nowMillis());
+                if (remainingMs < 0) remainingMs = 0;
+                batch[batchCount].seat = seat; batch[batchCount].option = option; batch[batchCount].remainingMs = remainingMs;
+                batchCount++;
+                answeredSeats |= 1 << seat;
+                cout << "\n" << results[seat].playerName << " locked in.\n";
+            }
+            long long nowt = nowMillis();
+            showRemainingSecondsLine(msToDisplaySeconds((int)(endMs - nowt)), "");
+            if (nowt >= endMs) break;
+            idlePause();
+        }
+        cout << "\n";
+
+        QuestionStats stats;
+        scoreAnswerBatch(q, qi, batch, batchCount, playerCount, results, st, stats);
+        sortRoomLeaderboard(order, playerCount, st);
+
+        cout << "Correct answer: " << q.options[q.correctIndex] << "\n";
+        displayQuestionNotes(categoryFile, q.bankIndex);
+        cout << "Room answers:";
+        for (int i = 0; i < q.optionCount; ++i) cout << "  " << i + 1 << ": " << stats.optionCounts[i];
+        cout << "  | correct " << stats.correct << "/" << playerCount << ", timeouts " << stats.timeouts;
+        if (stats.answered > 0) cout << ", avg " << stats.totalRemainingMs / stats.answered << " ms left";
+        cout << "\n";
+        for (int p = 0; p < playerCount; ++p) {
+            const QuestionOutcome& o = outcomeAt(results[p], results[p].qCount - 1);
+            cout << results[p].playerName << ": " << (o.kind == OUTCOME_TIMEOUT ? "time's up, " : "") << (o.points >= 0 ? "+" : "") << o.points << "\n";
+        }
+        displayRoomLeaderboard(order, playerCount, results, st);
+    }
+
+    cout << "\n================================\nRoom Completed!\n";
+    displayRoomLeaderboard(order, playerCount, results, st);
+    for (int p = 0; p < playerCount; ++p) {
+        results[p].score = st[p].score; results[p].correct = st[p].correct; results[p].wrong = st[p].wrong; results[p].timestamp = time(nullptr);
+        ScoreEntry e; e.name = results[p].playerName; e.score = (st[p].score < 0 ? 0 : st[p].score); e.datetime = nowString();
+        writeHighScore(highScoreFile, e);
+        logSession(logFile, results[p]);
+        releaseOutcomes(results[p]);
+    }
+    flushPendingWrites();
     cout << "Press Enter to return to menu..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
-int main() {
-    const string scienceFile = "science.txt";
-    const string sportsFile = "sports.txt";
-    const string historyFile = "history.txt";
-    const string computerFile = "computer.txt";
-    const string iqFile = "iq.txt";
+// ---------- Bank validation ----------
+// Checks a bank file record by record and reports every problem with its line number,
+// instead of the loader's silent skip. Errors make a record unloadable; warnings are
+// formatting inconsistencies. Banks are checked one after another: the game has no threads,
+// and one bank of a few hundred records checks in milliseconds.
+
+const int MAX_REPORTED_LINES = 5; // per warning kind, to keep reports readable
+
+// Validate one bank file; appends findings to report and returns the number of errors.
+int validateBankFile(const string& file, string& report, int& records, int& warnings) {
+    records = 0; warnings = 0;
+    ifstream fin(file.c_str(), ios::binary);
+    if (!fin.is_open()) { report += file + ": cannot open file\n"; return 1; }
+    int errors = 0;
+    char buf[256];
+    string block[MAX_RECORD_LINES];
+    int blockStart = 0, blockLines = 0;
+    int lineNo = 0, crlfLines = 0, lfLines = 0, trailingWs = 0, cleanLines = 0;
+    int wsLines[MAX_REPORTED_LINES], cleanList[MAX_REPORTED_LINES];
+    int nonUtf8 = 0; int nonUtf8Lines[MAX_REPORTED_LINES];
+    string seenText[MAX_QUESTIONS]; int seenLine[MAX_QUESTIONS]; int seenCount = 0;
+    string line;
+    bool more = true;
+    while (more) {
+        more = static_cast<bool>(getline(fin, line));
+        if (more) {
+            ++lineNo;
+            if (!line.empty() && line.back() == '\r') { crlfLines++; line.pop_back(); } else if (!fin.eof()) lfLines++;
+            size_t len = line.size();
+            trimRight(line);
+            bool trailing = (line.size() != len);
+            if (!isValidUtf8(line)) {
+                if (nonUtf8 < MAX_REPORTED_LINES) nonUtf8Lines[nonUtf8] = lineNo;
+                nonUtf8++;
+                normalizeBankText(line);
+            }
+            if (!line.empty()) {
+                if (trailing) { if (trailingWs < MAX_REPORTED_LINES) wsLines[trailingWs] = lineNo; trailingWs++; }
+                else { if (cleanLines < MAX_REPORTED_LINES) cleanList[cleanLines] = lineNo; cleanLines++; }
+                if (blockLines == 0) blockStart = lineNo;
+                if (blockLines < MAX_RECORD_LINES) block[blockLines] = line;
+                blockLines++;
+                continue;
+            }
+        }
+        if (blockLines == 0) continue;
+        // end of block: check it as one record
+        records++;
+        int metaStart = (blockLines <= MAX_RECORD_LINES) ? recordMetaStart(block, blockLines) : 0;
+        int optionCount = metaStart - 3;
+        if (blockLines < MIN_RECORD_LINES || blockLines > MAX_RECORD_LINES) {
+            snprintf(buf, sizeof(buf), "%s:%d: error: record has %d lines, expected question, 2-%d options (none if numeric), answer, difficulty and up to %d notes%s\n",
+                file.c_str(), blockStart, blockLines, MAX_OPTIONS, MAX_META_LINES, blockLines > MAX_RECORD_LINES ? "; missing blank line between records?" : "");
+            report += buf; errors++;
+        }
+        else if (optionCount == 1 || optionCount > MAX_OPTIONS) {
+            snprintf(buf, sizeof(buf), "%s:%d: error: record has %d option lines, expected 2-%d (none for a numeric question)\n", file.c_str(), blockStart, optionCount, MAX_OPTIONS);
+            report += buf; errors++;
+        }
+        else {
+            int type = 0, key = 0, diff = 0;
+            const string& answerLine = block[metaStart - 2];
+            const string& diffLine = block[metaStart - 1];
+            if (!parseAnswerLine(answerLine, optionCount, type, key)) {
+                if (optionCount == 0) snprintf(buf, sizeof(buf), "%s:%d: error: numeric answer '%s' must be a whole number\n", file.c_str(), blockStart + metaStart - 2, answerLine.c_str());
+                else snprintf(buf, sizeof(buf), "%s:%d: error: answer '%s' must be an option number 1-%d or a comma separated list of them\n", file.c_str(), blockStart + metaStart - 2, answerLine.c_str(), optionCount);
+                report += buf; errors++;
+            }
+            if (!parseStrictInt(diffLine, diff) || diff < 1 || diff > 3) {
+                // a misspelled note key leaves the note where the difficulty should be
+                if (diffLine.find(": ") != string::npos) snprintf(buf, sizeof(buf), "%s:%d: error: expected 'Explanation: ', 'Source: ' or 'Tags: ' after the difficulty\n", file.c_str(), blockStart + metaStart - 1);
+                else snprintf(buf, sizeof(buf), "%s:%d: error: difficulty '%s' must be 1-3\n", file.c_str(), blockStart + metaStart - 1, diffLine.c_str());
+                report += buf; errors++;
+            }
+            for (int i = 0; i < optionCount; ++i) for (int j = i + 1; j < optionCount; ++j) {
+                if (block[1 + i] == block[1 + j]) {
+                    snprintf(buf, sizeof(buf), "%s:%d: error: options %d and %d are identical\n", file.c_str(), blockStart + 1 + j, i + 1, j + 1);
+                    report += buf; errors++;
+                }
+            }
+            for (int s = 0; s < seenCount; ++s) {
+                if (seenText[s] == block[0]) {
+                    snprintf(buf, sizeof(buf), "%s:%d: warning: duplicate of question at line %d\n", file.c_str(), blockStart, seenLine[s]);
+                    report += buf; warnings++;
+                    break;
+                }
+            }
+            if (seenCount < MAX_QUESTIONS) { seenText[seenCount] = block[0]; seenLine[seenCount] = blockStart; seenCount++; }
+        }
+        blockLines = 0;
+    }
+    fin.close();
+
+    if (records > MAX_QUESTIONS) {
+        snprintf(buf, sizeof(buf), "%s: error: %d records, only the first %d can be loaded\n", file.c_str(), records, MAX_QUESTIONS);
+        report += buf; errors++;
+    }
+    if (nonUtf8 > 0) {
+        snprintf(buf, sizeof(buf), "%s: warning: %d lines are not UTF-8 (loaded as Windows-1252); first at line", file.c_str(), nonUtf8);
+        report += buf;
+        for (int i = 0; i < nonUtf8 && i < MAX_REPORTED_LINES; ++i) report += (i ? ", " : " ") + to_string(nonUtf8Lines[i]);
+        report += (nonUtf8 > MAX_REPORTED_LINES ? ", ...\n" : "\n");
+        warnings++;
+    }
+    if (crlfLines > 0 && lfLines > 0) {
+        snprintf(buf, sizeof(buf), "%s: warning: mixed line endings (%d CRLF, %d LF)\n", file.c_str(), crlfLines, lfLines);
+        report += buf; warnings++;
+    }
+    // trailing whitespace is harmless on its own (the loader trims it); a file mixing both styles
+    // usually means hand edits, so point at the minority lines
+    if (trailingWs > 0 && cleanLines > 0) {
+        bool wsMinority = trailingWs <= cleanLines;
+        int n = wsMinority ? trailingWs : cleanLines;
+        snprintf(buf, sizeof(buf), "%s: warning: inconsistent trailing whitespace (%d lines with, %d without); odd ones out at line",
+            file.c_str(), trailingWs, cleanLines);
+        report += buf;
+        for (int i = 0; i < n && i < MAX_REPORTED_LINES; ++i) report += (i ? ", " : " ") + to_string(wsMinority ? wsLines[i] : cleanList[i]);
+        report += (n > MAX_REPORTED_LINES ? ", ...\n" : "\n");
+        warnings++;
+    }
+    return errors;
+}
+
+// Validate bank files (all categories when none are given). Returns true if no errors.
+bool runValidate(const string files[], int fileCount) {
+    int totalErrors = 0, totalWarnings = 0, totalRecords = 0;
+    long long startMs = nowMillis();
+    for (int f = 0; f < fileCount; ++f) {
+        string report;
+        int records = 0, warnings = 0;
+        int errors = validateBankFile(files[f], report, records, warnings);
+        cout << report;
+        cout << files[f] << ": " << records << " records, " << errors << " errors, " << warnings << " warnings\n";
+        totalErrors += errors; totalWarnings += warnings; totalRecords += records;
+    }
+    cout << "Checked " << fileCount << " files, " << totalRecords << " records in " << nowMillis() - startMs << " ms: "
+        << totalErrors << " errors, " << totalWarnings << " warnings\n";
+    return totalErrors == 0;
+}
+
+// ---------- Replay ----------
+// Re-executes logged sessions against the current bank files and scoring rules.
+// A session is replayable when its log entry has the "Session:" and "Outcomes:" lines.
+
+const int MAX_REPLAY_SESSIONS = 2000;
+
+// Read the next log entry (up to the dashed separator). Returns false at end of file.
+// replayable is set when the entry carries seed and outcome records.
+bool readLoggedSession(ifstream& fin, QuizResult& r, bool& replayable) {
+    string line;
+    bool any = false, hasSession = false, hasOutcomes = false;
+    releaseOutcomes(r); // r is zeroed or a previous entry
+    r.playerName = ""; r.score = 0; r.correct = 0; r.wrong = 0;
+    r.seed = 0; r.categoryFile = ""; r.difficulty = 0; r.speedMode = false; r.remainingSecondsForCurrent = 0; r.mode = MODE_SOLO;
+    while (getline(fin, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        any = true;
+        if (line.compare(0, 3, "---") == 0) break;
+        if (line.compare(0, 8, "Player: ") == 0) {
+            size_t p = line.find(" | Score: ");
+            if (p == string::npos) continue;
+            r.playerName = line.substr(8, p - 8);
+            sscanf(line.c_str() + p, " | Score: %d | Correct: %d | Wrong: %d", &r.score, &r.correct, &r.wrong);
+        }
+        else if (line.compare(0, 9, "Session: ") == 0) {
+            unsigned int seed = 0; int d = 0, sp = 0;
+            size_t pc = line.find(" | Category: ");
+            size_t pd = line.find(" | Difficulty: ");
+            if (pc == string::npos || pd == string::npos || pd < pc) continue;
+            sscanf(line.c_str() + 9, "%u", &seed);
+            sscanf(line.c_str() + pd, " | Difficulty: %d | Speed: %d", &d, &sp);
+            r.seed = seed; r.difficulty = d; r.speedMode = (sp != 0);
+            r.categoryFile = line.substr(pc + 13, pd - pc - 13);
+            size_t pm = line.find(" | Mode: "); // absent in older logs: solo
+            for (int m = 0; m < MODE_COUNT && pm != string::npos; ++m) if (line.compare(pm + 9, string::npos, MODE_NAMES[m]) == 0) r.mode = m;
+            hasSession = true;
+        }
+        else if (line.compare(0, 10, "Outcomes: ") == 0) {
+            parseOutcomes(line.substr(10), r);
+            hasOutcomes = true;
+        }
+    }
+    replayable = hasSession && hasOutcomes;
+    return any;
+}
+
+// Re-run one logged session. Rebuilds the deck from the seed, checks every outcome
+// against the bank, and re-applies the outcomes under the current scoring rules.
+// Returns true when the logged totals are reproduced; otherwise appends reasons to report.
+bool replaySession(const QuizResult& logged, string& report) {
+    QuizRng rng; rngSeed(rng, logged.seed);
+    int deck[MAX_QUIZ_QUESTIONS];
+    int deckCount = 0;
+    static StreamSampler sampler; // survival and blitz runs redraw their question stream instead of a deck
+    static int sourceIds[MAX_SOURCE_IDS];
+    if (isStreamedMode(logged.mode)) samplerStart(sampler, sourceQuestionIds(logged.categoryFile, sourceIds), logged.seed);
+    else deckCount = buildSourceDeck(logged.categoryFile, logged.difficulty, logged.mode, rng, deck);
+    ScoreState st; st.score = 0; st.correct = 0; st.wrong = 0; st.streak = 0;
+    int replaced = 0;
+    bool ok = true;
+    char buf[160];
+    for (int i = 0; i < logged.qCount; ++i) {
+        QuestionOutcome o = outcomeAt(logged, i);
+        int slot = 0, index = 0, expected = -1;
+        if (isStreamedMode(logged.mode)) {
+            int pos = (o.questionIndex == i) ? samplerNext(sampler) : -1;
+            if (pos >= 0) expected = sourceIds[pos];
+            // a replaced question was swapped for the sampler's next draw (older runs drew the
+            // replacement from the whole source, so peek on a copy before consuming it)
+            if (pos >= 0 && o.bankIndex != expected && replaced == 0) {
+                static StreamSampler peek;
+                peek = sampler;
+                int next = samplerNext(peek);
+                if (next >= 0 && sourceIds[next] == o.bankIndex) { sampler = peek; expected = o.bankIndex; replaced++; }
+            }
+        }
+        else if (o.questionIndex >= 0 && o.questionIndex < deckCount) expected = deck[o.questionIndex];
+        if (expected < 0 || !resolveQuestion(logged.categoryFile, o.bankIndex, slot, index)) {
+            snprintf(buf, sizeof(buf), "  q%d: question %d not in rebuilt deck/bank\n", i + 1, o.bankIndex);
+            report += buf; ok = false; continue;
+        }
+        if (o.bankIndex != expected && ++replaced > 1) {
+            snprintf(buf, sizeof(buf), "  q%d: shown question %d, seed gives %d\n", i + 1, o.bankIndex, expected);
+            report += buf; ok = false;
+        }
+        const HotEntry& bq = catalog().banks[slot].hot[index];
+        if (o.difficulty != bq.difficulty) {
+            snprintf(buf, sizeof(buf), "  q%d: logged difficulty %d, bank has %d\n", i + 1, o.difficulty, bq.difficulty);
+            report += buf; ok = false;
+            o.difficulty = bq.difficulty;
+        }
+        if (o.kind == OUTCOME_CORRECT || o.kind == OUTCOME_WRONG) {
+            int kind = answerMatches(bq.type, bq.answerKey, o.bankAnswer) ? OUTCOME_CORRECT : OUTCOME_WRONG;
+            if (kind != o.kind) {
+                snprintf(buf, sizeof(buf), "  q%d: answer %d is now %s\n", i + 1, o.bankAnswer, kind == OUTCOME_CORRECT ? "correct" : "wrong");
+                report += buf; ok = false;
+                o.kind = kind;
+            }
+        }
+        int loggedPoints = o.points;
+        applyOutcome(st, o, logged.speedMode);
+        if (o.points != loggedPoints) {
+            snprintf(buf, sizeof(buf), "  q%d: logged %d points, rules now give %d\n", i + 1, loggedPoints, o.points);
+            report += buf; ok = false;
+        }
+    }
+    if (st.score != logged.score || st.correct != logged.correct || st.wrong != logged.wrong) {
+        snprintf(buf, sizeof(buf), "  totals: logged %d/%d/%d, replay %d/%d/%d (score/correct/wrong)\n",
+            logged.score, logged.correct, logged.wrong, st.score, st.correct, st.wrong);
+        report += buf; ok = false;
+    }
+    return ok;
+}
+
+// Replay every session in a log file 'repeat' times (the repeats make it usable as a
+// scoring benchmark with real traffic). Prints a summary; returns true when all sessions match.
+bool runReplay(const string& logFile, int repeat) {
+    static QuizResult sessions[MAX_REPLAY_SESSIONS];
+    int sCount = 0, legacy = 0;
+    ifstream fin(logFile.c_str());
+    if (!fin.is_open()) { cout << "Cannot open " << logFile << "\n"; return false; }
+    bool replayable = false;
+    while (sCount < MAX_REPLAY_SESSIONS && readLoggedSession(fin, sessions[sCount], replayable)) {
+        if (replayable) sCount++; else legacy++;
+    }
+    fin.close();
+
+    // banks come from the shared catalog, so each distinct file is loaded once
+    static int sourceIds[MAX_SOURCE_IDS];
+    bool haveSource[MAX_REPLAY_SESSIONS];
+    for (int i = 0; i < sCount; ++i) haveSource[i] = sourceQuestionIds(sessions[i].categoryFile, sourceIds) > 0;
+
+    if (repeat < 1) repeat = 1;
+    int matched = 0, mismatched = 0, missingBank = 0;
+    long long outcomesReplayed = 0;
+    long long startMs = nowMillis();
+    for (int pass = 0; pass < repeat; ++pass) {
+        for (int i = 0; i < sCount; ++i) {
+            if (!haveSource[i]) { if (pass == 0) missingBank++; continue; }
+            string report;
+            bool ok = replaySession(sessions[i], report);
+            outcomesReplayed += sessions[i].qCount;
+            if (pass > 0) continue;
+            if (ok) matched++;
+            else {
+                mismatched++;
+                cout << "Mismatch: " << sessions[i].playerName << " (seed " << sessions[i].seed << ", " << sessions[i].categoryFile << ")\n" << report;
+            }
+        }
+    }
+    long long elapsed = nowMillis() - startMs;
+
+    cout << "Replayed " << sCount << " sessions from " << logFile << " (" << legacy << " legacy entries without seed skipped";
+    if (sCount == MAX_REPLAY_SESSIONS) cout << ", stopped at " << MAX_REPLAY_SESSIONS;
+    cout << ")\n";
+    cout << "Matched: " << matched << " Mismatched: " << mismatched << " Missing bank: " << missingBank << "\n";
+    cout << "Passes: " << repeat << " Outcomes: " << outcomesReplayed << " Time: " << elapsed << " ms";
+    if (elapsed > 0) cout << " (" << outcomesReplayed * 1000 / elapsed << " outcomes/s)";
+    cout << "\n";
+    for (int i = 0; i <= sCount && i < MAX_REPLAY_SESSIONS; ++i) releaseOutcomes(sessions[i]);
+    return mismatched == 0 && missingBank == 0;
+}
+
+// Rebuild every rating from the session log: start a new generation and rate each logged
+// answer in log order, then write the question ratings once. Elo depends on the order of
+// matches, so the log is walked sequentially; this is the path for rule changes or a lost
+// ratings file. Until the file is written the old generation stays the current one.
+bool recomputeRatings(const string& logFile) {
+    ifstream fin(logFile.c_str());
+    if (!fin.is_open()) { cout << "Cannot open " << logFile << "\n"; return false; }
+    RatingStore& s = loadRatings();
+    int generation = s.generation + 1;
+    resetRatings(s);
+    s.generation = generation;
+    static QuizResult r;
+    int sessions = 0, answers = 0, players = 0;
+    bool replayable = false;
+    long long startMs = nowMillis();
+    while (readLoggedSession(fin, r, replayable)) {
+        if (!replayable) continue;
+        sessions++;
+        if (playerRating(r.playerName).games == 0) players++;
+        for (int i = 0; i < r.qCount; ++i) {
+            const QuestionOutcome& o = outcomeAt(r, i);
+            int id = globalQuestionId(r.categoryFile, o.bankIndex);
+            if (o.kind == OUTCOME_SKIPPED || id < 0) continue;
+            rateAnswer(r.playerName, id, o.difficulty, o.kind == OUTCOME_CORRECT, false);
+            answers++;
+        }
+    }
+    releaseOutcomes(r);
+    fin.close();
+    flushAppends(); // player ratings first: writing the file makes the new generation current
+    saveAllRatings(s);
+    cout << "Recomputed ratings from " << sessions << " sessions (" << answers << " answers, " << players << " players) in " << nowMillis() - startMs << " ms\n";
+    return true;
+}
+
+// Category file of the most recent logged session, or "" if none. Only the tail of the
+// log is read so this stays cheap however long the log grows.
+string lastPlayedCategory(const string& logFile) {
+    ifstream fin(logFile.c_str(), ios::binary);
+    if (!fin.is_open()) return "";
+    fin.seekg(0, ios::end);
+    streamoff size = fin.tellg();
+    const streamoff tailBytes = 4096;
+    fin.seekg(size > tailBytes ? size - tailBytes : 0, ios::beg);
+    string line, found;
+    while (getline(fin, line)) {
+        size_t pc = line.find(" | Category: ");
+        size_t pd = line.find(" | Difficulty: ");
+        if (line.compare(0, 9, "Session: ") == 0 && pc != string::npos && pd != string::npos && pd > pc)
+            found = line.substr(pc + 13, pd - pc - 13);
+    }
+    return found;
+}
+
+// Load the category the player is most likely to pick. Called after the menu is printed,
+// so the load overlaps with the player reading it instead of delaying the menu.
+void prefetchLikelyCategory(const string& logFile) {
+    string file = lastPlayedCategory(logFile);
+    if (file.empty()) file = CATEGORY_FILES[0];
+    if (isFilterSource(file)) loadAllCategoryBanks();
+    else findOrLoadBank(file);
+}
+
+// Print the category menu; returns a 0-based index into CATEGORY_FILES
+int selectCategory() {
+    cout << "\nSelect Category:\n";
+    for (int c = 0; c < NUM_CATEGORIES; ++c) cout << c + 1 << ". " << CATEGORY_NAMES[c] << "\n";
+    cout << "Enter (1-" << NUM_CATEGORIES << "): ";
+    return getIntInRange(1, NUM_CATEGORIES) - 1;
+}
+
+// Ask for a filter, show how many questions match, and run a quiz over the matches
+void startFilteredQuiz(const string& highScoreFile, const string& logFile) {
+    loadAllCategoryBanks();
+    cout << "\nFilter questions, e.g.: history AND europe OR science AND easy\nCategories:";
+    for (int c = 0; c < NUM_CATEGORIES; ++c) cout << " " << CATEGORY_FILES[c].substr(0, CATEGORY_FILES[c].find('.'));
+    cout << "\nDifficulty: easy medium hard (or difficulty:1-3)\nTags:";
+    const TagRegistry& tags = tagRegistry();
+    for (int t = 0; t < tags.count; ++t) cout << " " << tags.names[t];
+    if (tags.count == 0) cout << " (none in the loaded banks)";
+    cout << "\nFilter: ";
+    string query; getline(cin, query);
+    QuestionBitmap matches; string error;
+    if (!evaluateFilter(query, matches, error)) {
+        cout << "Invalid filter: " << error << "\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return;
+    }
+    static int ids[MAX_SOURCE_IDS];
+    int n = bitmapToIds(matches, ids);
+    if (n == 0) { cout << "No questions match.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return; }
+    cout << n << " questions match.\n";
+    startQuiz(FILTER_PREFIX + query, highScoreFile, logFile);
+}
+
+// Today's shared quiz, then its leaderboard
+void startDailyChallenge(const string& logFile) {
+    if (!prepareDailyDeck()) { cout << "Could not build today's challenge.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n'); return; }
+    const DailyDeck& deck = dailyDeck();
+    displayDailyScores(DAILY_SCORE_FILE, deck.date);
+    cout << "\nEveryone gets the same " << deck.count << " questions today. ";
+    ScoreBoard board; board.file = DAILY_SCORE_FILE; board.date = deck.date;
+    playQuiz(deck.source, board, logFile, deck);
+}
+
+int main(int argc, char* argv[]) {
+    long long startupMs = nowMillis();
+    if (argc >= 3 && string(argv[1]) == "--replay") {
+        int repeat = (argc >= 4) ? atoi(argv[3]) : 1;
+        return runReplay(argv[2], repeat) ? 0 : 1;
+    }
+    if (argc >= 2 && string(argv[1]) == "--recompute-ratings") {
+        return recomputeRatings(argc >= 3 ? argv[2] : "quiz_logs.txt") ? 0 : 1;
+    }
+    if (argc >= 2 && string(argv[1]) == "--validate") {
+        string files[MAX_BANKS]; int fileCount = 0;
+        for (int i = 2; i < argc && fileCount < MAX_BANKS; ++i) files[fileCount++] = argv[i];
+        if (fileCount == 0) for (int c = 0; c < NUM_CATEGORIES; ++c) files[fileCount++] = CATEGORY_FILES[c];
+        return runValidate(files, fileCount) ? 0 : 1;
+    }
+
     const string highScoreFile = "high_scores.txt";
     const string logFile = "quiz_logs.txt";
-    const string saveFile = "save_progress.txt";
 
+    // --startup-metric prints time-to-first-menu and prefetch time once the menu is up,
+    // and the session's cache counters on exit
+    bool showStartupMetric = (argc >= 2 && string(argv[1]) == "--startup-metric");
+    // --autosave-seconds N sets the most play a crash can lose (0 saves every change);
+    // --autosave-metric prints each quiz's autosave traffic
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--autosave-seconds" && i + 1 < argc) { int sec = atoi(argv[++i]); saveSlot().intervalMs = (sec > 0 ? sec : 0) * 1000; }
+        else if (arg == "--autosave-metric") saveSlot().report = true;
+    }
+    bool firstMenu = true;
+
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);
+#endif
     srand((unsigned)time(nullptr));
 
     while (true) {
         // system("cls"); // optional: uncomment if you want clear screen
         cout << "================================\n      Welcome to QuizMaster!\n================================\n\n";
-        cout << "1. Start Quiz\n2. View High Scores\n3. Resume Saved Quiz\n4. Exit Game\n\nPlease select an option (1-4): ";
-        int choice = getIntInRange(1, 4);
-        if (choice == 1) {
-            cout << "\nSelect Category:\n1. Science\n2. Sports\n3. History\n4. Computer\n5. IQ/Logic\nEnter (1-5): ";
-            int cat = getIntInRange(1, 5);
-            string chosenFile;
-            switch (cat) {
-            case 1: chosenFile = scienceFile; break;
-            case 2: chosenFile = sportsFile; break;
-            case 3: chosenFile = historyFile; break;
-            case 4: chosenFile = computerFile; break;
-            case 5: chosenFile = iqFile; break;
-            default: chosenFile = scienceFile; break;
+        cout << "1. Start Quiz\n2. View High Scores\n3. Resume Saved Quiz\n4. Head-to-Head Room\n5. Filtered Quiz (tags)\n6. Daily Challenge\n7. Study Missed Questions\n8. Exit Game\n\nPlease select an option (1-8): " << flush;
+        if (firstMenu) {
+            firstMenu = false;
+            long long menuMs = nowMillis();
+            prefetchLikelyCategory(logFile);
+            refillDeckCache(DECK_CACHE_REFILL_BUDGET);
+            kvIdle();
+            if (showStartupMetric) {
+                cerr << "[startup] first menu: " << menuMs - startupMs << " ms, prefetch: " << nowMillis() - menuMs << " ms\n";
+                for (int b = 0; b < catalog().bankCount; ++b) {
+                    const QuestionBank& bank = catalog().banks[b];
+                    if (bank.loaded) cerr << "[catalog] " << bank.file << ": " << bank.count << " questions, text " << bank.text.rawBytes << " -> " << bank.text.data.size() << " bytes\n";
+                }
+                reportPlayerStore();
             }
-            startQuiz(chosenFile, highScoreFile, logFile, saveFile);
+        }
+        else {
+            refillDeckCache(DECK_CACHE_REFILL_BUDGET); // quizzes popped decks since the last menu
+            kvIdle();
+            flushPendingWrites();
+        }
+        int choice = getIntInRange(1, 8);
+        if (choice == 1) {
+            string chosenFile = CATEGORY_FILES[selectCategory()];
+            startQuiz(chosenFile, highScoreFile, logFile);
         }
         else if (choice == 2) {
+            displayTopRatings();
             displayTopHighScores(highScoreFile);
         }
         else if (choice == 3) {
+            cout << "Enter your name: "; string name; getline(cin, name); if (name.empty()) name = "Player";
             QuizResult r;
-            if (!loadProgress(saveFile, r)) {
+            if (!loadSavedProgress(name, r)) {
                 cout << "No saved progress found.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
             }
             else {
@@ -620,17 +3897,7 @@ int main() {
                 cout << "Found saved progress for player: " << r.playerName << " | Score so far: " << r.score << "\n";
                 cout << "This simplified resume will restore your name, score, and remaining seconds for the next question.\n";
                 cout << "To continue, select category to play (pick the same category you used earlier if possible).\n";
-                cout << "Select Category:\n1. Science\n2. Sports\n3. History\n4. Computer\n5. IQ/Logic\nEnter (1-5): ";
-                int cat = getIntInRange(1, 5);
-                string chosenFile;
-                switch (cat) {
-                case 1: chosenFile = scienceFile; break;
-                case 2: chosenFile = sportsFile; break;
-                case 3: chosenFile = historyFile; break;
-                case 4: chosenFile = computerFile; break;
-                case 5: chosenFile = iqFile; break;
-                default: chosenFile = scienceFile; break;
-                }
+                selectCategory();
                 cout << "Resuming: player name and score restored. Remaining seconds saved: " << r.remainingSecondsForCurrent << "s (used for first question).\n";
                 cout << "Press Enter to start resumed quiz..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
@@ -644,11 +3911,32 @@ int main() {
                 // For simplicity and clarity: inform the user resume is partially supported and return to main.
                 cout << "Note: Fully accurate resume (exact previous question/order) requires more saved state. This simplified resume is informational only.\nPress Enter to return..."; cin.ignore(numeric_limits<streamsize>::max(), '\n');
             }
+            releaseOutcomes(r);
         }
         else if (choice == 4) {
+            string chosenFile = CATEGORY_FILES[selectCategory()];
+            startRoom(chosenFile, highScoreFile, logFile);
+        }
+        else if (choice == 5) {
+            startFilteredQuiz(highScoreFile, logFile);
+        }
+        else if (choice == 6) {
+            startDailyChallenge(logFile);
+        }
+        else if (choice == 7) {
+            startStudy();
+        }
+        else if (choice == 8) {
             cout << "Are you sure you want to exit? (Y/N): ";
             string s; getline(cin, s);
-            if (!s.empty() && (s[0] == 'Y' || s[0] == 'y')) { cout << "Goodbye!\n"; break; }
+            if (!s.empty() && (s[0] == 'Y' || s[0] == 'y')) {
+                flushPendingWrites();
+                if (showStartupMetric) {
+                    cerr << "[deck cache] " << deckCache().hits << " hits, " << deckCache().misses << " misses\n";
+                    reportPlayerStore();
+                }
+                cout << "Goodbye!\n"; break;
+            }
         }
     }
     return 0;